@@ -1,5 +1,39 @@
 
 
+#
+# Packed images
+#
+# With PACK=1, the SBC targets below produce a smaller image, which loads
+# faster from a slow device: emutos.img is compressed by tools/lz4pack.c,
+# and prefixed with util/unpack.S, which unpacks it in place at boot.
+# SBC_LOAD_RATE is the assumed loading speed (in bytes per second), only
+# used to estimate the load time.
+#
+
+PACK = 0
+SBC_LOAD_RATE = 20000
+PACKED_IMG = emutos-packed.img
+SBC_IMG = $(if $(filter 1,$(PACK)),$(PACKED_IMG),emutos.img)
+TOCLEAN += lz4pack obj/emutos.lz4
+
+NODEP += lz4pack
+lz4pack: tools/lz4pack.c
+	$(NATIVECC) $< -o $@
+
+obj/emutos.lz4: emutos.img lz4pack
+	./lz4pack emutos.img $@
+
+# incbin dependencies are not automatically detected
+obj/unpack.o: obj/emutos.lz4
+
+$(PACKED_IMG): obj/unpack.o
+	$(LD) $+ $(PCREL_LDFLAGS) -o $@
+	@RAW=$$(wc -c <emutos.img); PACKED=$$(wc -c <$@);\
+	echo "# $@: $$PACKED bytes, emutos.img: $$RAW bytes";\
+	echo "# Estimated load time at $(SBC_LOAD_RATE) bytes/s:"\
+	"$$(($$PACKED / $(SBC_LOAD_RATE))).$$(($$PACKED * 10 / $(SBC_LOAD_RATE) % 10)) s"\
+	"instead of $$(($$RAW / $(SBC_LOAD_RATE))).$$(($$RAW * 10 / $(SBC_LOAD_RATE) % 10)) s"
+
 #
 # Tiny68K image
 #
@@ -13,8 +47,8 @@ tiny68k: OPTFLAGS = $(STANDARD_OPTFLAGS)
 tiny68k: override DEF += -DMACHINE_TINY68K
 tiny68k: WITH_AES = 0
 tiny68k:
-	$(MAKE) DEF='$(DEF)' OPTFLAGS='$(OPTFLAGS)' UNIQUE=$(UNIQUE) WITH_AES=$(WITH_AES) emutos.img
-	cp emutos.img $(TINY68K_IMG)
+	$(MAKE) DEF='$(DEF)' OPTFLAGS='$(OPTFLAGS)' UNIQUE=$(UNIQUE) WITH_AES=$(WITH_AES) $(SBC_IMG)
+	cp $(SBC_IMG) $(TINY68K_IMG)
 	@MEMBOT=$(call SHELL_SYMADDR,__end_os_stram,emutos.map);\
 	echo "# RAM used: $$(($$MEMBOT)) bytes ($$(($$MEMBOT - $(MEMBOT_TOS206))) bytes more than TOS 2.06)"
 	@printf "$(LOCALCONFINFO)"
@@ -32,8 +66,8 @@ rosco_v2: OPTFLAGS = $(STANDARD_OPTFLAGS)
 rosco_v2: override DEF += -DMACHINE_ROSCO_V2
 rosco_v2: WITH_AES = 0
 rosco_v2:
-	$(MAKE) DEF='$(DEF)' OPTFLAGS='$(OPTFLAGS)' UNIQUE=$(UNIQUE) WITH_AES=$(WITH_AES) emutos.img
-	cp emutos.img $(ROSCO_V2_IMG)
+	$(MAKE) DEF='$(DEF)' OPTFLAGS='$(OPTFLAGS)' UNIQUE=$(UNIQUE) WITH_AES=$(WITH_AES) $(SBC_IMG)
+	cp $(SBC_IMG) $(ROSCO_V2_IMG)
 	@MEMBOT=$(call SHELL_SYMADDR,__end_os_stram,emutos.map);\
 	echo "# RAM used: $$(($$MEMBOT)) bytes ($$(($$MEMBOT - $(MEMBOT_TOS206))) bytes more than TOS 2.06)"
 	@printf "$(LOCALCONFINFO)"
@@ -21,6 +21,8 @@
 #define CLEAR_WORKSTATION       3
 
 #define ESCAPE_FUNCTION         5
+#define ESC_VBATCH              0x4554  /* EmuTOS: begin/end a batch */
+#define ESC_VSHIELD             0x4553  /* EmuTOS: hide cursor if in the way */
 #define POLYLINE                6
 
 #define TEXT                    8
@@ -3,7 +3,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2022 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -27,11 +27,196 @@
 #include "gemqueue.h"
 #include "gemasm.h"
 #include "gemasync.h"
+#include "gemdosif.h"
 
 #include "string.h"
 #include "biosext.h"
 
 
+/*
+ * the timer queue
+ *
+ * timer events (MU_TIMER) are kept in a binary heap, ordered by the tick
+ * at which they expire, so adding one is O(log n).  while an EVB is in
+ * the queue, its e_parm is its index in the heap, so cancelling it is
+ * O(1): its slot is just emptied, and is discarded when it reaches the
+ * top of the heap.  should the heap fill up with empty slots, it is
+ * rebuilt without them.
+ *
+ * the tick interrupt code (tikcod in gemdosif.S) counts CMP_TICK down
+ * and NUM_TICK up while CMP_TICK is non-zero, and forks tchange() when
+ * CMP_TICK reaches zero.  the current time is tq_base + NUM_TICK.
+ */
+#define TQ_SIZE (NUM_PDS * 4)
+
+typedef struct {
+    ULONG due;                  /* tick at which the event expires */
+    EVB *evb;                   /* the event, or NULL if cancelled */
+} TQENTRY;
+
+static TQENTRY tq_heap[TQ_SIZE];
+static WORD tq_count;           /* # of entries used in tq_heap[] */
+static ULONG tq_base;           /* time when NUM_TICK was last zeroed */
+
+
+void tq_init(void)
+{
+    tq_count = 0;
+    tq_base = 0L;
+    CMP_TICK = NUM_TICK = 0L;
+}
+
+
+/* store entry 't' in heap slot 'i' */
+static void tq_set(WORD i, const TQENTRY *t)
+{
+    tq_heap[i] = *t;
+    if (t->evb)
+        t->evb->e_parm = i;
+}
+
+
+static void tq_up(WORD i)
+{
+    TQENTRY t = tq_heap[i];
+    WORD parent;
+
+    while (i > 0)
+    {
+        parent = (i - 1) / 2;
+        if ((LONG)(tq_heap[parent].due - t.due) <= 0)
+            break;
+        tq_set(i, &tq_heap[parent]);
+        i = parent;
+    }
+    tq_set(i, &t);
+}
+
+
+static void tq_down(WORD i)
+{
+    TQENTRY t = tq_heap[i];
+    WORD child;
+
+    while ((child = 2 * i + 1) < tq_count)
+    {
+        if ((child + 1 < tq_count) && ((LONG)(tq_heap[child+1].due - tq_heap[child].due) < 0))
+            child++;
+        if ((LONG)(t.due - tq_heap[child].due) <= 0)
+            break;
+        tq_set(i, &tq_heap[child]);
+        i = child;
+    }
+    tq_set(i, &t);
+}
+
+
+/* remove the top of the heap */
+static void tq_pop(void)
+{
+    if (--tq_count > 0)
+    {
+        tq_set(0, &tq_heap[tq_count]);
+        tq_down(0);
+    }
+}
+
+
+/* rebuild the heap without the cancelled events */
+static void tq_compact(void)
+{
+    WORD i, n;
+
+    for (i = n = 0; i < tq_count; i++)
+        if (tq_heap[i].evb)
+            tq_set(n++, &tq_heap[i]);
+    tq_count = n;
+
+    for (i = n / 2 - 1; i >= 0; i--)
+        tq_down(i);
+}
+
+
+/*
+ * discard the cancelled events at the top of the heap, then set up
+ * the tick interrupt code to fork tchange() when the first event expires
+ *
+ * must be called with interrupts disabled
+ */
+static void tq_arm(void)
+{
+    LONG c;
+
+    while (tq_count && !tq_heap[0].evb)
+        tq_pop();
+
+    tq_base += NUM_TICK;
+    NUM_TICK = 0L;
+
+    if (!tq_count)
+    {
+        CMP_TICK = 0L;
+        return;
+    }
+
+    c = tq_heap[0].due - tq_base;
+    CMP_TICK = (c > 0L) ? c : 1L;
+}
+
+
+/*
+ * add a timer event that expires in 'c' ticks
+ */
+void tq_add(EVB *e, LONG c)
+{
+    TQENTRY t;
+
+    disable_interrupts();
+
+    /* there is at most one timer event per process, so this makes room */
+    if (tq_count >= TQ_SIZE)
+        tq_compact();
+
+    t.due = tq_base + NUM_TICK + c;
+    t.evb = e;
+    tq_set(tq_count, &t);
+    tq_up(tq_count++);
+
+    if (e->e_parm == 0)         /* it's the first one to expire */
+        tq_arm();
+
+    enable_interrupts();
+}
+
+
+/*
+ * complete all the timer events that have expired
+ */
+void tq_expire(void)
+{
+    EVB *e;
+    ULONG now;
+
+    disable_interrupts();
+    now = tq_base + NUM_TICK;
+    enable_interrupts();
+
+    while (tq_count)
+    {
+        e = tq_heap[0].evb;
+        if (e && ((LONG)(tq_heap[0].due - now) > 0))
+            break;
+        tq_pop();
+        if (e)
+            azombie(e, 0);
+    }
+
+    disable_interrupts();
+    tq_arm();
+    enable_interrupts();
+}
+
+
 static void signal(EVB *e)
 {
     AESPD *p, *p1, **pp1;
@@ -95,19 +280,14 @@ void evinsert(EVB *e, EVB **root)
 
 static void takeoff(EVB *p)
 {
-    LONG c;
-
-    /* take event p off e_link list, must be NODISP */
-    p->e_pred->e_link = p->e_link;
-    if (p->e_link)
+    /* take event p off the timer queue or e_link list, must be NODISP */
+    if (p->e_flag & EVDELAY)
+        tq_heap[p->e_parm].evb = NULL;
+    else
     {
-        p->e_link->e_pred = p->e_pred;
-        if (p->e_flag & EVDELAY)
-        {
-            c = p->e_link->e_parm;
-            c += p->e_parm;
-            p->e_link->e_parm = c;
-        }
+        p->e_pred->e_link = p->e_link;
+        if (p->e_link)
+            p->e_link->e_pred = p->e_pred;
     }
     p->e_nextp = eul;
     eul = p;
@@ -1,7 +1,7 @@
 /*
  * gemasync.h - header for EmuTOS AES process synchronization functions
  *
- * Copyright (C) 2002-2020 The EmuTOS development team
+ * Copyright (C) 2002-2026 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -10,6 +10,9 @@
 #ifndef GEMASYNC_H
 #define GEMASYNC_H
 
+void tq_init(void);
+void tq_add(EVB *e, LONG c);
+void tq_expire(void);
 void azombie(EVB *e, UWORD ret);
 void evinsert(EVB *e, EVB **root);
 EVSPEC mwait(EVSPEC mask);
@@ -4,7 +4,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2021 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -37,6 +37,8 @@
 #include "gemdosif.h"
 
 #include "asm.h"
+#include "biosext.h"
+#include "tosvars.h"
 
 #define KEYMASK 0xffff0000L             /* for comparing data to KEYSTOP */
 #define KEYSTOP 0x2b1c0000L             /* control-backslash */
@@ -198,9 +200,7 @@ static void schedule(void)
         /* check if there is something to run */
         if (rlr || fpcnt)
             break;
-#if USE_STOP_INSN_TO_FREE_HOST_CPU
-        stop_until_interrupt();
-#endif
+        idle_wait();
     }
 }
 
@@ -222,6 +222,19 @@ void disp(void)
 {
     AESPD *p;
 
+    /*
+     * count the dispatcher passes per second.  this is useful to tune
+     * the AES, and can be inspected via the pointer to D in the global
+     * array (ap_3resv).
+     */
+    D.g_dsppass++;
+    if (hz_200 - D.g_dspstart >= 200L)
+    {
+        D.g_dsprate = D.g_dsppass;
+        D.g_dsppass = 0;
+        D.g_dspstart = hz_200;
+    }
+
     /* take the process p off the ready list root */
     p = rlr;
     rlr = p->p_link;
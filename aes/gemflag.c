@@ -3,7 +3,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2019 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -29,42 +29,18 @@
 
 
 
-void tchange(LONG c)            /* c=number of ticks that have gone by  */
+/*
+ * called via the fork ring when the first timer event expires
+ *
+ * c is the number of ticks that have gone by; the timer queue gets it
+ * from NUM_TICK, which is up to date even if the queue has changed since
+ * the fork (c is still used when recording events, see gemdisp.c)
+ */
+void tchange(LONG c)
 {
-    EVB *d;
-    LONG c1;
-
-    /*
-     * pull pd's off the delay list that have waited long enough
-     */
-    d = dlr;
-    while (d)
-    {
-        /* take a bite out of the amount of time the pd is waiting */
-        c1 = c - d->e_parm;
-        d->e_parm -= c;
-        c = c1;
+    UNUSED(c);
 
-        /* finished waiting? */
-        if (d->e_parm <= 0L)
-        {
-            d->e_parm = 0L;
-            evremove(d, 0);
-            d = dlr;
-        }
-        else
-        {
-            /*
-             * set compare tick time to the amount the
-             * first guy is waiting
-             */
-            disable_interrupts();
-            CMP_TICK = d->e_parm;
-            NUM_TICK = 0L;
-            enable_interrupts();
-            break;
-        }
-    }
+    tq_expire();
 }
 
 
@@ -364,7 +364,7 @@ WORD fm_alert(WORD defbut, char *palstr)
 
     /* draw the alert       */
     gsx_sclip(&d);
-    ob_draw(tree, ROOT, MAX_DEPTH);
+    ob_draw_cached(tree, ROOT, MAX_DEPTH);
 
     /*
      * turn on the mouse and set the mouse owner.  the latter is required
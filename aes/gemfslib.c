@@ -284,7 +284,7 @@ static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
 
     user_dta = dos_gdta();          /* remember user's DTA */
     dos_sdta(&D.g_dta);
-    ret = dos_sfirst(allpath, FA_SUBDIR);
+    ret = dos_sfirst_bulk(allpath, FA_SUBDIR);
 
     /*
      * like Atari TOS, we silently ignore any filenames that we don't
@@ -303,7 +303,7 @@ static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
                 thefile++;
             }
         }
-        ret = dos_snext();
+        ret = dos_snext_bulk();
     }
 
     *pcount = thefile;
@@ -1,7 +1,7 @@
 /*
  * gemgsxif.c - AES's interface to VDI (gsx)
  *
- * Copyright 2002-2023 The EmuTOS development team
+ * Copyright 2002-2026 The EmuTOS development team
  *           1999, Caldera Thin Clients, Inc.
  *           1987, Digital Research Inc.
  *
@@ -76,6 +76,9 @@ GLOBAL WORD  ptsout[12];
 GLOBAL WORD  gl_moff;                /* counting semaphore   */
                                      /*  == 0 implies ON     */
                                      /*  >  0 implies OFF    */
+#if CONF_WITH_MOUSE_SHIELD
+static BOOL  gl_mshield;             /* TRUE if OFF, but possibly shown */
+#endif
 
 static FDB   gl_tmp;
 static PFVOID old_mcode;
@@ -206,6 +209,9 @@ void ratinit(void)
 {
     gsx_1code(SHOW_CUR, 0);
     gl_moff = 0;
+#if CONF_WITH_MOUSE_SHIELD
+    gl_mshield = FALSE;
+#endif
 }
 
 
@@ -393,6 +399,56 @@ void bb_restore(GRECT *pr)
 }
 
 
+#if OBJC_CACHE_SIZE
+/*
+ * return the size of the buffer needed by bb_copy() for the specified area
+ */
+LONG bb_size(const GRECT *r)
+{
+    return memsize(((r->g_x & 15) + r->g_w + 15) / 16, r->g_h, gl_nplanes);
+}
+
+
+/*
+ * copy a screen area to (save=TRUE) or from (save=FALSE) a buffer
+ *
+ * unlike bb_save()/bb_restore(), the area is not rounded to word
+ * boundaries, so no pixels outside it are restored.  it is stored at
+ * the same bit offset within a word as on the screen, so that no shifting
+ * is needed.  the caller must turn the mouse off.
+ */
+void bb_copy(BOOL save, const GRECT *r, void *buf)
+{
+    FDB mem;
+    WORD pxyarray[8], *pts1, *pts2;
+    WORD dx = r->g_x & 15;
+
+    gsx_fix_screen(&gl_src);
+    gsx_fix_screen(&mem);
+    mem.fd_addr = buf;
+    mem.fd_wdwidth = (dx + r->g_w + 15) / 16;
+    mem.fd_w = mem.fd_wdwidth * 16;
+    mem.fd_h = r->g_h;
+
+    pts1 = save ? pxyarray : pxyarray + 4;
+    pts2 = save ? pxyarray + 4 : pxyarray;
+    pts1[0] = r->g_x;
+    pts1[1] = r->g_y;
+    pts1[2] = r->g_x + r->g_w - 1;
+    pts1[3] = r->g_y + r->g_h - 1;
+    pts2[0] = dx;
+    pts2[1] = 0;
+    pts2[2] = dx + r->g_w - 1;
+    pts2[3] = r->g_h - 1;
+
+    if (save)
+        vro_cpyfm(S_ONLY, pxyarray, &gl_src, &mem);
+    else
+        vro_cpyfm(S_ONLY, pxyarray, &mem, &gl_src);
+}
+#endif
+
+
 
 WORD gsx_tick(void *tcode, void *ptsave)
 {
@@ -451,8 +507,68 @@ void gsx_mon(void)
 {
     gl_moff--;
     if (!gl_moff)
+    {
+#if CONF_WITH_MOUSE_SHIELD
+        gl_mshield = FALSE;
+#endif
         gsx_1code(SHOW_CUR, 1);
+    }
+}
+
+
+
+#if CONF_WITH_MOUSE_SHIELD
+/*
+ *  Like gsx_moff(), for drawing within the specified area: the VDI
+ *  leaves the mouse cursor on the screen if it is outside the area
+ */
+void gsx_mshield(const GRECT *pt)
+{
+    if (!gl_moff)
+    {
+        ptsin[0] = pt->g_x;
+        ptsin[1] = pt->g_y;
+        ptsin[2] = pt->g_x + pt->g_w - 1;
+        ptsin[3] = pt->g_y + pt->g_h - 1;
+        contrl[5] = ESC_VSHIELD;
+        gsx_ncode(ESCAPE_FUNCTION, 2, 0);
+        gl_mshield = TRUE;
+    }
+
+    gl_moff++;
+}
+
+
+
+/*
+ *  Make sure that the mouse cursor, which must be OFF, is not on the
+ *  screen; used before calling code that may draw outside the area
+ *  passed to gsx_mshield()
+ */
+void gsx_munshield(void)
+{
+    if (gl_mshield)
+    {
+        gsx_0code(HIDE_CUR);    /* a nested hide removes it ... */
+        gsx_1code(SHOW_CUR, 1); /* ... and it stays hidden */
+        gl_mshield = FALSE;
+    }
+}
+#endif
+
+
+
+#if CONF_WITH_VDI_BATCH
+/*
+ *  Begin/end a VDI batch: until the batch ends, the VDI may queue,
+ *  merge and discard overdrawn rectangle fills
+ */
+void gsx_batch(BOOL begin)
+{
+    contrl[5] = ESC_VBATCH;
+    gsx_1code(ESCAPE_FUNCTION, begin ? 1 : 0);
 }
+#endif
 
 
 
@@ -34,6 +34,10 @@ void gsx_init(void);
 void gsx_graphic(BOOL tographic);
 void bb_save(GRECT *ps);
 void bb_restore(GRECT *pr);
+#if OBJC_CACHE_SIZE
+LONG bb_size(const GRECT *r);
+void bb_copy(BOOL save, const GRECT *r, void *buf);
+#endif
 
 WORD gsx_tick(void *tcode, void *ptsave);
 void gsx_mfset(const MFORM *pmfnew);
@@ -42,6 +46,15 @@ void gsx_mxmy(WORD *pmx, WORD *pmy);
 WORD gsx_kstate(void);
 void gsx_mon(void);
 void gsx_moff(void);
+#if CONF_WITH_MOUSE_SHIELD
+void gsx_mshield(const GRECT *pt);
+void gsx_munshield(void);
+#else
+#define gsx_mshield(pt) gsx_moff()
+#endif
+#if CONF_WITH_VDI_BATCH
+void gsx_batch(BOOL begin);
+#endif
 WORD gsx_char(void);
 void gsx_setmousexy(WORD x, WORD y);
 WORD gsx_nplanes(void);
@@ -38,6 +38,7 @@
 #include "gemshlib.h"
 #include "gempd.h"
 #include "gemrslib.h"
+#include "gemasync.h"
 #include "gemdos.h"
 #include "gemevlib.h"
 #include "gemwmlib.h"
@@ -129,7 +130,7 @@ GLOBAL MFORM    gl_prevmouse;           /* previous AES  mouse form */
 #endif
 
 GLOBAL AESPD    *rlr, *drl, *nrl;
-GLOBAL EVB      *eul, *dlr, *zlr;
+GLOBAL EVB      *eul, *zlr;
 
 GLOBAL UBYTE    indisp;
 
@@ -674,6 +675,10 @@ void run_accs_and_desktop(void)
 
     gsx_init();                     /* do gsx open work station */
 
+#if CONF_WITH_COLOUR_ICONS && CICON_CACHE_SIZE
+    rs_cache_init();                /* allocate colour icon cache */
+#endif
+
 #if CONF_WITH_MENU_EXTENSION
     mnext_init();                   /* initialise menu library extension variables */
 #endif
@@ -813,6 +818,11 @@ void gem_main(void)
         bzero(D.g_acc,num_accs*sizeof(AESPROCESS));
     else num_accs = 0;
 
+    /* additional rectangle list entries, used by or_start() */
+    D.g_oreserve = NULL;
+    if (NUM_ORECT_RESERVE)
+        D.g_oreserve = dos_alloc_anyram(NUM_ORECT_RESERVE*sizeof(ORECT));
+
     totpds = num_accs + 2;
 
     disable_interrupts();
@@ -841,7 +851,8 @@ void gem_main(void)
 
     /* initialize list and unused lists   */
     nrl = drl = NULL;
-    dlr = zlr = NULL;
+    zlr = NULL;
+    tq_init();
     fph = fpt = fpcnt = 0;
 
     /* init initial process */
@@ -895,6 +906,8 @@ void gem_main(void)
     unset_aestrap();
     enable_interrupts();
 
+    if (D.g_oreserve)
+        dos_free(D.g_oreserve);
     if (D.g_acc)
         dos_free(D.g_acc);
 }
@@ -495,50 +495,11 @@ void akbin(EVB *e)
 
 void adelay(EVB *e, LONG c)
 {
-    EVB *p, *q;
-
     if (c == 0L)
         c = 1L;
 
-    disable_interrupts();
-    if (CMP_TICK)
-    {
-        /*
-         * if already counting down, then reset CMP_TICK to the lower
-         * number, but let NUM_TICK grow from its accumulated value
-         */
-        if (c <= CMP_TICK)
-            CMP_TICK = c;
-    }
-    else
-    {
-        /*
-         * if we aren't currently counting down for someone else,
-         * then start ticking
-         */
-        CMP_TICK = c;
-        NUM_TICK = 0L;      /* start NUM_TICK out at zero */
-    }
-
     e->e_flag |= EVDELAY;
-    q = FAKE_EVB(&dlr);
-    for (p = dlr; p; p = (q = p) -> e_link)
-    {
-        if (c <= p->e_parm)
-            break;
-        c -= p->e_parm;
-    }
-    e->e_pred = q;
-    q->e_link = e;
-    e->e_parm = c;
-    e->e_link = p;
-    if (p)
-    {
-        c = p->e_parm - c;
-        p->e_pred = e;
-        p->e_parm = c;
-    }
-    enable_interrupts();
+    tq_add(e, c);
 }
 
 
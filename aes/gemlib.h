@@ -85,7 +85,7 @@ typedef struct window
     ORECT *w_rnext;             /* used for search first, search next */
 } WINDOW;
 
-#define NUM_ORECT (NUM_WIN * 10)        /* is this enough???    */
+#define NUM_ORECT (NUM_WIN * 10)        /* fixed pool, extended by NUM_ORECT_RESERVE */
 
 #define WS_FULL 0
 #define WS_CURR 1
@@ -141,6 +141,12 @@ typedef struct
                                 /*   more than one menu_register()!       */
 
     AESPROCESS *g_acc;          /* for up to NUM_ACCS desk accessories */
+    ORECT *g_oreserve;          /* NUM_ORECT_RESERVE additional orects */
+
+    /* dispatcher statistics, for tuning: see disp() in gemdisp.c */
+    UWORD g_dsppass;            /* dispatcher passes in the current second */
+    UWORD g_dsprate;            /* dispatcher passes in the last second */
+    LONG  g_dspstart;           /* value of hz_200 at start of current second */
 } THEGLO;
 
 #endif /* GEMLIB_H */
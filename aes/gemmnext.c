@@ -256,7 +256,7 @@ static WORD handle_popup(MENU *menu)
     /* initially, mark start item as selected & draw entire box */
     if (!(tree[obj].ob_state & DISABLED))
         tree[obj].ob_state |= SELECTED;
-    ob_draw(tree, menu->mn_menu, MAX_DEPTH);
+    ob_draw_cached(tree, menu->mn_menu, MAX_DEPTH);
     oldobj = obj;
 
     gr_mkstate(&mx, &my, &dummy, &dummy);
@@ -671,7 +671,7 @@ OBJECT *display_submenu(OBJECT *tree, WORD objnum, WORD *smroot)
         return NULL;
 
     /* display the submenu tree */
-    ob_draw(smtree, submenu->s_menu, MAX_DEPTH);
+    ob_draw_cached(smtree, submenu->s_menu, MAX_DEPTH);
 
     *smroot = submenu->s_menu;
     return smtree;
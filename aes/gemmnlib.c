@@ -238,7 +238,7 @@ static WORD menu_down(OBJECT *tree, WORD ititle)
         /* save area underneath the menu */
         menu_sr(TRUE, tree, imenu);
         /* draw all items in menu */
-        ob_draw(tree, imenu, MAX_DEPTH);
+        ob_draw_cached(tree, imenu, MAX_DEPTH);
     }
 
     return imenu;
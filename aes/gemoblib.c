@@ -3,7 +3,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2022 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -32,7 +32,9 @@
 #include "optimopt.h"
 #include "rectfunc.h"
 #include "gemoblib.h"
+#include "gemdos.h"
 
+#include "intmath.h"
 #include "string.h"
 
 
@@ -444,6 +446,10 @@ static WORD ob_user(OBJECT *tree, WORD obj, GRECT *pt, LONG spec,
     gsx_gclip((GRECT *)&pb.pb_xc);      /* FIXME: ditto */
     pb.pb_parm = ub->ub_parm;
 
+#if CONF_WITH_MOUSE_SHIELD
+    gsx_munshield();    /* we can't trust the user code to clip */
+#endif
+
     return call_usercode(ub, &pb);
 }
 
@@ -970,12 +976,313 @@ void ob_draw(OBJECT *tree, WORD obj, WORD depth)
     else
         sx = sy = 0;
 
-    gsx_moff();
+    /* only the clip area is drawn (if set) */
+    if (gl_clip.g_w && gl_clip.g_h)
+        gsx_mshield(&gl_clip);
+    else
+        gsx_moff();
     everyobj(tree, obj, last, just_draw, sx, sy, depth);
     gsx_mon();
 }
 
 
+#if OBJC_CACHE_SIZE
+/*
+ * the object tree image cache
+ *
+ * the AES draws the same menus and alerts over and over again.  so
+ * ob_draw_cached() keeps an image of what it has drawn, and blits it
+ * back the next time the same (sub)tree is drawn at the same place,
+ * rather than drawing every object again.
+ *
+ * an image is only used if the tree still looks the same: its signature
+ * is computed from the position, size, type, flags, state & spec of
+ * every object drawn, the structure that the spec points to, and any
+ * text.  so any change by objc_change(), objc_add(), objc_delete() or
+ * objc_edit(), or directly by the program, causes the tree to be drawn
+ * (and cached) again.  this also works for menu items that are
+ * highlighted by ob_change() while the menu is down, and are back to
+ * normal when the menu is next pulled down.
+ *
+ * only trees with an opaque root object (a box of some kind) which
+ * contains all the other objects, and without user-defined objects, are
+ * cached.  also, they must be drawn entirely, and on the screen.
+ */
+#define OBC_ENTRIES 4               /* max # of images in cache */
+#define OBC_MIN     4096L           /* don't bother with a smaller buffer */
+
+typedef struct {
+    OBJECT *tree;                   /* tree & object drawn */
+    WORD obj;
+    ULONG sig;                      /* signature of the objects drawn */
+    GRECT area;                     /* screen area covered */
+    char *data;                     /* image, see bb_copy() */
+} OBCENTRY;
+
+static char *obc_buf;               /* image buffer, or NULL */
+static LONG obc_size;               /* size of image buffer */
+static LONG obc_used;               /* bytes used in image buffer */
+static WORD obc_count;              /* # of entries used in obc_entry[] */
+static OBCENTRY obc_entry[OBC_ENTRIES];
+
+static ULONG obc_sig;               /* set by ob_sign() */
+static GRECT obc_area;              /* used by ob_sign() */
+static BOOL obc_ok;                 /* set by ob_sign() */
+
+
+/*
+ * allocate the image buffer: called when the AES enters graphics mode
+ */
+void ob_cache_init(void)
+{
+    LONG size;
+
+    obc_buf = NULL;
+    obc_count = 0;
+    obc_used = 0;
+
+    size = min(dos_avail_anyram() / 16, OBJC_CACHE_SIZE) & ~1L;
+    if (size < OBC_MIN)
+        return;
+
+    obc_buf = dos_alloc_anyram(size);
+    obc_size = size;
+}
+
+
+/*
+ * free the image buffer: called when the AES leaves graphics mode
+ */
+void ob_cache_free(void)
+{
+    if (obc_buf)
+        dos_free(obc_buf);
+    obc_buf = NULL;
+}
+
+
+/*
+ * discard all the images
+ */
+static void ob_cache_flush(void)
+{
+    obc_count = 0;
+    obc_used = 0;
+}
+
+
+/*
+ * return TRUE iff rectangle 'in' lies entirely within rectangle 'out'
+ */
+static BOOL rc_within(const GRECT *in, const GRECT *out)
+{
+    GRECT t = *in;
+
+    return rc_intersect(out, &t) && rc_equal(&t, in);
+}
+
+
+/*
+ * adjust an object rectangle to include everything drawn outside it,
+ * except the shadow
+ */
+static void ob_extent(GRECT *pt, WORD state, WORD flags, WORD th)
+{
+    if (state & OUTLINED)
+        gr_inside(pt, -3);
+    else if (th < 0)
+        gr_inside(pt, th);
+#if CONF_WITH_3D_OBJECTS
+    if (flags & FL3DOBJ)
+        gr_inside(pt, -(ADJ3DSTD+ADJ3DOUT));
+#endif
+}
+
+
+static void sig_add(ULONG value)
+{
+    obc_sig = ((obc_sig << 5) | (obc_sig >> 27)) + value;
+}
+
+
+static void sig_mem(const void *p, WORD len)
+{
+    const UWORD *w = p;
+
+    for (len /= sizeof(UWORD); len > 0; len--)
+        sig_add(*w++);
+}
+
+
+static void sig_str(const char *s)
+{
+    do
+        sig_add(*s);
+    while (*s++);
+}
+
+
+/*
+ * add an object to the signature, and check that it can be cached
+ *
+ * called via everyobj()
+ */
+static void ob_sign(OBJECT *tree, WORD obj, WORD sx, WORD sy)
+{
+    WORD state, obtype, flags, th;
+    LONG spec;
+    GRECT t;
+    TEDINFO *ted;
+
+    ob_sst(tree, obj, &spec, &state, &obtype, &flags, &t, &th);
+    if ((flags & HIDETREE) || (spec == -1L))
+        return;
+
+    t.g_x = sx;
+    t.g_y = sy;
+    sig_mem(&t, sizeof(t));
+    sig_add(MAKE_ULONG(obtype, flags));
+    sig_add(MAKE_ULONG(state, th));
+    sig_add(spec);
+
+    ob_extent(&t, state, flags, th);
+    if (state & SHADOWED)
+        gr_inside(&t, (th < 0) ? 3 * th : -3 * th);
+    if (!rc_within(&t, &obc_area))
+        obc_ok = FALSE;
+
+    switch(obtype)
+    {
+    case G_TEXT:
+    case G_BOXTEXT:
+    case G_FTEXT:
+    case G_FBOXTEXT:
+        ted = (TEDINFO *)spec;
+        sig_mem(ted, sizeof(TEDINFO));
+        sig_str(ted->te_ptext);
+        if ((obtype == G_FTEXT) || (obtype == G_FBOXTEXT))
+            sig_str(ted->te_ptmplt);
+        break;
+    case G_IMAGE:
+        sig_mem((BITBLK *)spec, sizeof(BITBLK));
+        break;
+    case G_ICON:
+    case G_CICON:       /* a CICONBLK starts with an ICONBLK */
+        sig_mem((ICONBLK *)spec, sizeof(ICONBLK));
+        sig_str(((ICONBLK *)spec)->ib_ptext);
+        if (obtype == G_CICON)
+            sig_add((LONG)((CICONBLK *)spec)->mainlist);
+        break;
+    case G_BUTTON:
+    case G_STRING:
+    case G_TITLE:
+        sig_str((char *)spec);
+        break;
+    case G_USERDEF:
+        obc_ok = FALSE;
+        break;
+    }
+}
+
+
+/*
+ * like ob_draw(), but use the cached image of the tree if possible
+ */
+void ob_draw_cached(OBJECT *tree, WORD obj, WORD depth)
+{
+    OBCENTRY *e, *found = NULL;
+    WORD state, obtype, flags, th;
+    WORD pobj, last = NIL, sx, sy, i;
+    LONG spec, size;
+
+    if (!obc_buf)
+        goto draw;
+
+    /*
+     * the root object must be opaque
+     */
+    ob_sst(tree, obj, &spec, &state, &obtype, &flags, &obc_area, &th);
+    if ((flags & HIDETREE) || (state & SHADOWED) || (spec == -1L))
+        goto draw;
+#if CONF_WITH_3D_OBJECTS
+    if (flags & FL3DOBJ)
+        goto draw;
+#endif
+    if ((obtype != G_BOX) && (obtype != G_BOXCHAR)
+     && (obtype != G_BOXTEXT) && (obtype != G_FBOXTEXT))
+        goto draw;
+
+    ob_offset(tree, obj, &obc_area.g_x, &obc_area.g_y);
+    ob_extent(&obc_area, state, flags, th);
+    if (!rc_within(&obc_area, &gl_rscreen))
+        goto draw;
+    if (gl_clip.g_w && gl_clip.g_h && !rc_within(&obc_area, &gl_clip))
+        goto draw;
+
+    /*
+     * compute the signature, checking that the tree can be cached
+     */
+    if (obj != ROOT)
+        last = tree[obj].ob_next;
+    pobj = get_par(tree, obj);
+    if (pobj != NIL)
+        ob_offset(tree, pobj, &sx, &sy);
+    else
+        sx = sy = 0;
+
+    obc_sig = obj;
+    obc_ok = TRUE;
+    everyobj(tree, obj, last, ob_sign, sx, sy, depth);
+    if (!obc_ok)
+        goto draw;
+
+    for (i = 0, e = obc_entry; i < obc_count; i++, e++)
+    {
+        if ((e->tree != tree) || (e->obj != obj))
+            continue;
+        if ((e->sig == obc_sig) && rc_equal(&e->area, &obc_area))
+        {
+            gsx_mshield(&obc_area);
+            bb_copy(FALSE, &obc_area, e->data);
+            gsx_mon();
+            return;
+        }
+        found = e;      /* out of date */
+    }
+
+    /*
+     * draw the tree, then save its image: reuse the out-of-date entry
+     * if the image has the same size, else add a new one
+     */
+    ob_draw(tree, obj, depth);
+
+    size = bb_size(&obc_area);
+    if (size > obc_size)
+        return;
+    if (!found || (size != bb_size(&found->area)))
+    {
+        if ((obc_count >= OBC_ENTRIES) || (obc_used + size > obc_size))
+            ob_cache_flush();
+        found = &obc_entry[obc_count++];
+        found->data = obc_buf + obc_used;
+        obc_used += size;
+    }
+    found->tree = tree;
+    found->obj = obj;
+    found->sig = obc_sig;
+    found->area = obc_area;
+
+    gsx_mshield(&obc_area);
+    bb_copy(TRUE, &obc_area, found->data);
+    gsx_mon();
+    return;
+
+draw:
+    ob_draw(tree, obj, depth);
+}
+#endif /* OBJC_CACHE_SIZE */
+
+
 /*
  *  Routine to find the object that is previous to us in the
  *  tree.  The idea is we get our parent and then walk down
@@ -1385,6 +1692,9 @@ WORD ob_sysvar(WORD mode, WORD which, WORD in1, WORD in2, WORD *out1, WORD *out2
             return 0;
             break;
         }
+#if OBJC_CACHE_SIZE
+        ob_cache_flush();       /* cached images may look different now */
+#endif
         return 1;
     }
 
@@ -1,7 +1,7 @@
 /*
  * gemoblib.h - header for EmuTOS AES Object Library functions
  *
- * Copyright (C) 2002-2022 The EmuTOS development team
+ * Copyright (C) 2002-2026 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -12,6 +12,13 @@
 
 void ob_format(WORD just, char *raw_str, char *tmpl_str, char *fmt_str);
 void ob_draw(OBJECT *tree, WORD obj, WORD depth);
+#if OBJC_CACHE_SIZE
+void ob_cache_init(void);
+void ob_cache_free(void);
+void ob_draw_cached(OBJECT *tree, WORD obj, WORD depth);
+#else
+#define ob_draw_cached(tree, obj, depth) ob_draw(tree, obj, depth)
+#endif
 WORD ob_find(OBJECT *tree, WORD currobj, WORD depth, WORD mx, WORD my);
 void ob_add(OBJECT *tree, WORD parent, WORD child);
 WORD ob_delete(OBJECT *tree, WORD obj);
@@ -3,7 +3,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2022 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -22,6 +22,7 @@
 #include "aesdefs.h"
 #include "aesext.h"
 #include "gem_rsc.h"
+#include "aesvars.h"
 
 #include "gemdos.h"
 #include "gemshlib.h"
@@ -356,6 +357,48 @@ static void transform_cicon(WORD *src, WORD *dest, WORD w, WORD h, WORD planes)
     vrn_trnfm(&gl_src, &gl_dst);
 }
 
+/*
+ * convert the data of a CICON to device-dependent form in 'buf', followed
+ * by the 'selected' data if present, and point the CICON to it
+ *
+ * 'expandbuf' must be large enough for the data (data_size bytes) if the
+ * icon must be expanded
+ */
+static void convert_cicon(CICON *cicon, WORD *buf, WORD *expandbuf, WORD w, WORD h, LONG data_size)
+{
+    WORD *src;
+    BOOL expand;
+
+    expand = (cicon->num_planes != gl_nplanes); /* boolean */
+
+    /* handle standard icon */
+    src = cicon->col_data;
+    if (expand)
+    {
+        expand_cicondata(src, expandbuf, cicon->col_mask, w, h, cicon->num_planes, gl_nplanes);
+        src = expandbuf;
+    }
+    transform_cicon(src, buf, w, h, gl_nplanes);
+    cicon->col_data = buf;
+
+    /* handle 'selected' icon (if present) */
+    if (cicon->sel_data)
+    {
+        buf += data_size/sizeof(WORD);
+        src = cicon->sel_data;
+        if (expand)
+        {
+            expand_cicondata(src, expandbuf, cicon->sel_mask, w, h, cicon->num_planes, gl_nplanes);
+            src = expandbuf;
+        }
+        transform_cicon(src, buf, w, h, gl_nplanes);
+        cicon->sel_data = buf;
+    }
+
+    cicon->num_planes = gl_nplanes;     /* neatness only */
+    cicon->next_res = NULL;
+}
+
 /*
  * for each CICONBLK in the resource, select the CICON with the number of
  * planes that best matches the current resolution.  then expand the icon
@@ -365,9 +408,8 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
 {
     CICONBLK *ciconblk;
     CICON *cicon;
-    WORD *colbuf, *selbuf, *expandbuf, *src;
+    WORD *colbuf, *expandbuf;
     LONG data_size, n;
-    BOOL expand;
     WORD i, w, h;
 
     for (i = 0; i < num_cicons; i++)
@@ -380,11 +422,10 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
         w = ciconblk->monoblk.ib_wicon;
         h = ciconblk->monoblk.ib_hicon;
         data_size = muls(w/8*gl_nplanes,h);
-        expand = (cicon->num_planes != gl_nplanes); /* boolean */
 
         /* if we need to expand the icon, we need a temp buffer */
         expandbuf = NULL;
-        if (expand)
+        if (cicon->num_planes != gl_nplanes)
         {
             expandbuf = dos_alloc_anyram(data_size);
             if (!expandbuf)
@@ -405,38 +446,387 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
             continue;
         }
 
-        /* handle standard icon */
-        src = cicon->col_data;
-        if (expand)
+        convert_cicon(cicon, colbuf, expandbuf, w, h, data_size);
+
+        if (expandbuf)
+            dos_free(expandbuf);
+    }
+}
+
+#if CICON_CACHE_SIZE
+/*
+ * the colour icon cache
+ *
+ * GEM programs usually load the same resource file each time they are
+ * run, so the converted CICON data is kept in a cache, and shared by
+ * all the loaded resources read from the same file (same full path,
+ * length, date & time).
+ *
+ * the cache is a single block allocated by rs_cache_init() when the
+ * desktop starts, so that it belongs to the AES rather than to the
+ * program that loaded the resource.  it contains a list of entries,
+ * sorted by address.  when there is no room for a new entry, the least
+ * recently used entries that are not used by a loaded resource are
+ * discarded.  if memory runs short, rsrc_load() gives back the part of
+ * the block that is not in use.
+ *
+ * an entry is in use while a process that loaded it has not freed the
+ * resource.  since a program may terminate without calling rsrc_free(),
+ * the shell also releases its entries when it terminates.
+ */
+#define CICACHE_MIN     4096L       /* don't bother with smaller caches */
+
+typedef struct cicache CICACHE;
+struct cicache {
+    CICACHE *next;                  /* next entry, by address */
+    LONG length;                    /* length of entry, including header */
+    UWORD users;                    /* processes using it (bit = pid) */
+    UWORD lru;                      /* value of cicache_clock when last used */
+    LONG rsclen;                    /* resource file length */
+    UWORD time;                     /* resource file time & date */
+    UWORD date;
+    char name[MAXPATHLEN];          /* full path of resource file */
+    /* followed by the converted CICON data, in CICONBLK order */
+};
+
+static char *cicache_start;         /* start of cache block, or NULL */
+static LONG cicache_size;           /* size of cache block */
+static CICACHE *cicache_list;       /* entries in cache, by address */
+static UWORD cicache_clock;         /* incremented on each use */
+static CICACHE cicache_key;         /* resource file being loaded */
+
+#define PID_BIT(pid)            (1 << (pid))
+#define CICACHE_LENGTH(datalen) (((LONG)sizeof(CICACHE) + (datalen) + 3) & ~3L)
+
+
+/*
+ * initialise the cache
+ *
+ * this must be called after the workstation has been opened, in the
+ * process that runs the desktop
+ */
+void rs_cache_init(void)
+{
+    LONG size;
+
+    cicache_start = NULL;
+    cicache_list = NULL;
+
+    if (gl_nplanes < 2)     /* colour resolutions only */
+        return;
+
+    size = min(dos_avail_anyram() / 8, CICON_CACHE_SIZE) & ~3L;
+    if (size < CICACHE_MIN)
+        return;
+
+    cicache_start = dos_alloc_anyram(size);
+    cicache_size = size;
+}
+
+
+/*
+ * set up cicache_key for the resource file being loaded
+ */
+static void cicache_setkey(UWORD fd, LONG rsclen)
+{
+    char *p = cicache_key.name;
+    WORD drive;
+
+    cicache_key.rsclen = rsclen;
+    if (dos_getdt(fd, &cicache_key.time, &cicache_key.date) < 0)
+    {
+        *p = '\0';                  /* cannot cache this one */
+        return;
+    }
+
+    /* make sure the path includes the drive & directory */
+    if (tmprsfname[0] && (tmprsfname[1] == DRIVESEP))
+    {
+        strcpy(p, tmprsfname);
+        return;
+    }
+
+    drive = dos_gdrv();
+    *p++ = drive + 'A';
+    *p++ = DRIVESEP;
+    *p = '\0';
+    if (tmprsfname[0] != PATHSEP)
+    {
+        dos_gdir(drive+1, p);
+        p += strlen(p);
+        *p++ = PATHSEP;
+        *p = '\0';
+    }
+
+    if (strlen(cicache_key.name) + strlen(tmprsfname) < MAXPATHLEN)
+        strcpy(p, tmprsfname);
+    else
+        cicache_key.name[0] = '\0';
+}
+
+
+/*
+ * find the cache entry for the resource file being loaded
+ */
+static CICACHE *cicache_find(void)
+{
+    CICACHE *e;
+
+    for (e = cicache_list; e; e = e->next)
+    {
+        if ((e->rsclen == cicache_key.rsclen) && (e->time == cicache_key.time)
+         && (e->date == cicache_key.date) && !strcmp(e->name, cicache_key.name))
+            return e;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * discard the least recently used entry that is not in use
+ *
+ * returns FALSE if there is none
+ */
+static BOOL cicache_discard(void)
+{
+    CICACHE *e, **prev, **oldest = NULL;
+    UWORD age, maxage = 0;
+
+    for (prev = &cicache_list; (e = *prev) != NULL; prev = &e->next)
+    {
+        if (e->users)
+            continue;
+        age = cicache_clock - e->lru;
+        if (!oldest || (age >= maxage))
         {
-            expand_cicondata(src, expandbuf, cicon->col_mask, w, h, cicon->num_planes, gl_nplanes);
-            src = expandbuf;
+            oldest = prev;
+            maxage = age;
         }
-        transform_cicon(src, colbuf, w, h, gl_nplanes);
-        cicon->col_data = colbuf;
+    }
+
+    if (!oldest)
+        return FALSE;
+
+    *oldest = (*oldest)->next;
 
-        /* handle 'selected' icon (if present) */
-        if (cicon->sel_data)
+    return TRUE;
+}
+
+
+/*
+ * allocate a new entry for the resource file being loaded, with room
+ * for 'datalen' bytes of data
+ */
+static CICACHE *cicache_alloc(LONG datalen)
+{
+    CICACHE *e, **prev, *new;
+    char *addr;
+    LONG length = CICACHE_LENGTH(datalen);
+
+    if (length > cicache_size)
+        return NULL;
+
+    for (;;)
+    {
+        /* look for the first gap that is large enough */
+        addr = cicache_start;
+        for (prev = &cicache_list; ; prev = &e->next)
         {
-            selbuf = colbuf + data_size/sizeof(WORD);
-            src = cicon->sel_data;
-            if (expand)
+            e = *prev;
+            if ((e ? (char *)e : cicache_start+cicache_size) - addr >= length)
             {
-                expand_cicondata(src, expandbuf, cicon->sel_mask, w, h, cicon->num_planes, gl_nplanes);
-                src = expandbuf;
+                new = (CICACHE *)addr;
+                *new = cicache_key;
+                new->next = e;
+                new->length = length;
+                new->users = PID_BIT(rlr->p_pid);
+                new->lru = ++cicache_clock;
+                *prev = new;
+                return new;
             }
-            transform_cicon(src, selbuf, w, h, gl_nplanes);
-            cicon->sel_data = selbuf;
+            if (!e)
+                break;
+            addr = (char *)e + e->length;
         }
 
-        cicon->num_planes = gl_nplanes;     /* neatness only */
-        cicon->next_res = NULL;
+        if (!cicache_discard())
+            return NULL;
+    }
+}
 
-        if (expandbuf)
-            dos_free(expandbuf);
+
+/*
+ * if 'data' is in the cache, the current process releases the entry
+ * containing it
+ *
+ * returns TRUE iff it was
+ */
+static BOOL cicache_release(void *data)
+{
+    CICACHE *e;
+
+    if (((char *)data < cicache_start) || ((char *)data >= cicache_start+cicache_size))
+        return FALSE;
+
+    for (e = cicache_list; e; e = e->next)
+    {
+        if ((char *)data < (char *)e + e->length)
+        {
+            e->users &= ~PID_BIT(rlr->p_pid);
+            break;
+        }
     }
+
+    return TRUE;
 }
 
+
+/*
+ * release all the cache entries used by a process that has terminated,
+ * whether it freed its resources or not
+ */
+void rs_cache_release(WORD pid)
+{
+    CICACHE *e;
+
+    for (e = cicache_list; e; e = e->next)
+        e->users &= ~PID_BIT(pid);
+}
+
+
+/*
+ * give back the memory used by the cache that is not in use
+ *
+ * returns TRUE iff some memory was freed
+ */
+static BOOL cicache_reclaim(void)
+{
+    CICACHE *e;
+    LONG size;
+
+    if (!cicache_start)
+        return FALSE;
+
+    while (cicache_discard())
+        ;
+
+    /* only the end of the block can be given back */
+    for (size = 0, e = cicache_list; e; e = e->next)
+        size = (char *)e + e->length - cicache_start;
+
+    if (size == cicache_size)
+        return FALSE;
+
+    if (size == 0)
+    {
+        dos_free(cicache_start);
+        cicache_start = NULL;
+    }
+    else
+        dos_shrink(cicache_start, size);
+    cicache_size = size;
+
+    return TRUE;
+}
+
+
+/*
+ * like transform_all_cicons(), but use the converted data in the cache
+ * if present, or else convert the data into a new cache entry
+ *
+ * returns FALSE if the cache cannot be used
+ */
+static BOOL cache_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
+{
+    CICACHE *entry;
+    CICONBLK *ciconblk;
+    CICON *cicon;
+    WORD *buf, *expandbuf = NULL;
+    LONG data_size, total = 0, maxexpand = 0;
+    BOOL hit;
+    WORD i, w, h;
+
+    if (!cicache_start || !cicache_key.name[0])
+        return FALSE;
+
+    /* select the CICONs and compute the length of the converted data */
+    for (i = 0; i < num_cicons; i++)
+    {
+        ciconblk = ciconblkptr[i];
+        cicon = best_match(ciconblk);
+        ciconblk->mainlist = cicon;
+        if (!cicon)
+            continue;
+        data_size = muls(ciconblk->monoblk.ib_wicon/8*gl_nplanes, ciconblk->monoblk.ib_hicon);
+        total += cicon->sel_data ? 2*data_size : data_size;
+        if ((cicon->num_planes != gl_nplanes) && (data_size > maxexpand))
+            maxexpand = data_size;
+    }
+
+    entry = cicache_find();
+    hit = (entry != NULL);
+    if (hit)
+    {
+        /*
+         * a process loading the same resource file twice gets its own
+         * copy, since it may free either one first
+         */
+        if (entry->users & PID_BIT(rlr->p_pid))
+            return FALSE;
+        if (entry->length != CICACHE_LENGTH(total))     /* should not happen */
+            return FALSE;
+        entry->users |= PID_BIT(rlr->p_pid);
+        entry->lru = ++cicache_clock;
+    }
+    else
+    {
+        if (maxexpand)
+        {
+            expandbuf = dos_alloc_anyram(maxexpand);
+            if (!expandbuf)
+                return FALSE;
+        }
+        entry = cicache_alloc(total);
+        if (!entry)
+        {
+            if (expandbuf)
+                dos_free(expandbuf);
+            return FALSE;
+        }
+    }
+
+    buf = (WORD *)(entry + 1);
+    for (i = 0; i < num_cicons; i++)
+    {
+        ciconblk = ciconblkptr[i];
+        cicon = ciconblk->mainlist;
+        if (!cicon)
+            continue;
+        w = ciconblk->monoblk.ib_wicon;
+        h = ciconblk->monoblk.ib_hicon;
+        data_size = muls(w/8*gl_nplanes,h);
+
+        if (hit)
+        {
+            cicon->col_data = buf;
+            if (cicon->sel_data)
+                cicon->sel_data = buf + data_size/sizeof(WORD);
+            cicon->num_planes = gl_nplanes;
+            cicon->next_res = NULL;
+        }
+        else
+            convert_cicon(cicon, buf, expandbuf, w, h, data_size);
+        buf += (cicon->sel_data ? 2*data_size : data_size) / sizeof(WORD);
+    }
+
+    if (expandbuf)
+        dos_free(expandbuf);
+
+    return TRUE;
+}
+#endif /* CICON_CACHE_SIZE */
+
 /*
  * return pointer to start of CICONBLK pointer table
  *
@@ -488,9 +878,14 @@ static WORD free_cicon_buffers(RSHDR *hdr)
     for (p = ciconblkptr; *p != (CICONBLK *)-1L; p++)
     {
         cicon = (*p)->mainlist;
-        if (cicon)
-            if (dos_free(cicon->col_data))
-                rc = -1;
+        if (!cicon)
+            continue;
+#if CICON_CACHE_SIZE
+        if (cicache_release(cicon->col_data))
+            break;          /* all the data is in the same cache entry */
+#endif
+        if (dos_free(cicon->col_data))
+            rc = -1;
     }
 
     return rc;
@@ -528,6 +923,12 @@ static void fix_cicons(void)
     /* fixup the pointers in the resource */
     fixup_all_ciconblks(num_ciconblks, ciconblkptr, cicondata);
 
+#if CICON_CACHE_SIZE
+    /* use the cached icons if possible */
+    if (cache_all_cicons(num_ciconblks, ciconblkptr))
+        return;
+#endif
+
     /* transform all the icons to device-dependent format */
     transform_all_cicons(num_ciconblks, ciconblkptr);
 }
@@ -734,6 +1135,11 @@ static WORD rs_readit(AESGLOBAL *pglobal,UWORD fd)
 #endif
 
     rs_hdr = (RSHDR *)dos_alloc_anyram(rslsize);
+#if CONF_WITH_COLOUR_ICONS && CICON_CACHE_SIZE
+    if (!rs_hdr && cicache_reclaim())
+        rs_hdr = (RSHDR *)dos_alloc_anyram(rslsize);
+    cicache_setkey(fd, rslsize);
+#endif
     if (!rs_hdr)
         return FALSE;
 
@@ -1,7 +1,7 @@
 /*
  * gemrslib.h - header for EmuTOS AES Resource Library functions
  *
- * Copyright (C) 2002-2020 The EmuTOS development team
+ * Copyright (C) 2002-2026 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -33,5 +33,9 @@ WORD rs_gaddr(AESGLOBAL *pglobal, UWORD rtype, UWORD rindex, void **rsaddr);
 WORD rs_saddr(AESGLOBAL *pglobal, UWORD rtype, UWORD rindex, void *rsaddr);
 void rs_fixit(AESGLOBAL *pglobal);
 WORD rs_load(AESGLOBAL *pglobal, char *rsfname);
+#if CONF_WITH_COLOUR_ICONS && CICON_CACHE_SIZE
+void rs_cache_init(void);
+void rs_cache_release(WORD pid);
+#endif
 
 #endif
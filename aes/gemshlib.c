@@ -46,6 +46,7 @@
 #include "geminit.h"
 #include "gemaplib.h"
 #include "gemmnlib.h"
+#include "gemrslib.h"
 
 #include "string.h"
 #include "miscutil.h"
@@ -234,6 +235,9 @@ void sh_tographic(void)
     gsx_graphic(TRUE);      /* convert to graphic */
     gsx_sclip(&gl_rscreen); /* set initial clip rectangle */
     gsx_malloc();           /* allocate screen space */
+#if OBJC_CACHE_SIZE
+    ob_cache_init();        /* allocate menu/alert image cache */
+#endif
     ratinit();              /* start up the mouse */
     set_mouse_to_hourglass();/* put mouse to hourglass */
 }
@@ -256,6 +260,9 @@ static void sh_toalpha(void)
 
     ratexit();              /* turn off the mouse */
     gsx_mfree();            /* return screen space */
+#if OBJC_CACHE_SIZE
+    ob_cache_free();        /* return menu/alert image cache */
+#endif
     gsx_graphic(FALSE);     /* close workstation */
 }
 
@@ -644,6 +651,10 @@ static WORD sh_ldapp(SHELL *psh)
 
         ret = dos_exec(PE_LOADGO, D.s_cmd, ad_stail, ad_envrn); /* Run the APP */
 
+#if CONF_WITH_COLOUR_ICONS && CICON_CACHE_SIZE
+        rs_cache_release(rlr->p_pid);   /* in case it didn't rsrc_free() */
+#endif
+
         /* if the user did an appl_init() without an appl_exit(),
          * do the important parts for him
          */
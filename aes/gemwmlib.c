@@ -1008,7 +1008,10 @@ void w_update(WORD bottom, GRECT *pt, WORD top, BOOL moved)
 
     /* limit to screen */
     rc_intersect(&gl_rfull, pt);
-    gsx_moff();
+    gsx_mshield(pt);
+#if CONF_WITH_VDI_BATCH
+    gsx_batch(TRUE);
+#endif
 
     /* update windows from top to bottom */
     if (bottom == DESKWH)
@@ -1044,6 +1047,9 @@ void w_update(WORD bottom, GRECT *pt, WORD top, BOOL moved)
         while(!done);
     }
 
+#if CONF_WITH_VDI_BATCH
+    gsx_batch(FALSE);
+#endif
     gsx_mon();
 }
 
@@ -1057,7 +1063,7 @@ void w_update(WORD bottom, GRECT *pt, WORD top, BOOL moved)
  */
 static void draw_change(WORD w_handle, GRECT *pt)
 {
-    GRECT   c, pprev;
+    GRECT   c, pprev, oldext;
     GRECT   *pw;
     WORD    start, stop;
     BOOL    moved;
@@ -1066,6 +1072,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
     wasclr = !(D.w_win[w_handle].w_flags & VF_BROKEN);
 
     /* save old size */
+    w_getsize(WS_TRUE, w_handle, &oldext);
     w_getsize(WS_CURR, w_handle, &c);
     w_setsize(WS_PREV, w_handle, &c);
 
@@ -1086,7 +1093,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
         return;
 
     /* update rectangle lists */
-    everyobj(gl_wtree, ROOT, NIL, (EVERYOBJ_CALLBACK)newrect, 0, 0, MAX_DEPTH);
+    updrect(gl_wtree, w_handle, &oldext);
 
     /* remember oldtop & set new one */
     oldtop = gl_wtop;
@@ -1241,6 +1248,32 @@ static void w_owns(WINDOW *pwin, ORECT *po, GRECT *pt, GRECT *poutwds)
 }
 
 
+/*
+ *  Copy the visible parts of the rectangle pt to the array prect, which
+ *  has room for max entries.  Returns the number of visible parts, which
+ *  may be larger than max.
+ */
+static WORD w_allowns(WINDOW *pwin, GRECT *pt, GRECT *prect, WORD max)
+{
+    ORECT   *po;
+    GRECT   t;
+    WORD    n;
+
+    for (po = pwin->w_rlist, n = 0; po; po = po->o_link)
+    {
+        rc_copy(&po->o_gr, &t);
+        if (rc_intersect(pt, &t))
+        {
+            if (n < max)
+                rc_copy(&t, prect++);
+            n++;
+        }
+    }
+
+    return n;
+}
+
+
 /*
  *  (Re)initialize window manager internal variables, excluding window colours
  */
@@ -1473,7 +1506,7 @@ BOOL wm_delete(WORD w_handle)
     if (pwin->w_flags & VF_ISOPEN)  /* window is open      */
         wm_close(w_handle);         /* - so close it first */
 
-    newrect(gl_wtree, w_handle);      /* give back recs. */
+    freerect(w_handle);             /* give back recs. */
     w_setsize(WS_CURR, w_handle, &gl_rscreen);
     w_setsize(WS_PREV, w_handle, &gl_rscreen);
     w_setsize(WS_FULL, w_handle, &gl_rfull);
@@ -1501,6 +1534,20 @@ BOOL wm_delete(WORD w_handle)
  *  Note 2: the application program binding for wind_get(WF_COLOR/WF_DCOLOR) is
  *  a special case since there are three intin[] values, rather than the two
  *  used for all other wind_get() functions.
+ *
+ *  Note 3: WF_XRLIST is an EmuTOS extension that returns the whole
+ *  rectangle list of a window in one call, instead of one rectangle per
+ *  WF_FIRSTXYWH/WF_NEXTXYWH call:
+ *  wind_get(handle, WF_XRLIST, &parm1, &parm2, &parm3, &parm4)
+ *      input:  parm1/parm2 contain the high/low words of the address of
+ *                a GRECT array
+ *              parm3 contains the number of entries in the array
+ *      output: parm1 contains the number of GRECTs stored in the array
+ *              parm2 contains the total number of GRECTs in the list; if
+ *                this is larger than parm1, the array was too small
+ *  As for WF_FIRSTXYWH, the rectangles are clipped to the work area.
+ *  The binding must pass five intin[] values (handle, mode, parm1, parm2,
+ *  parm3) so that the full address and the count reach the AES.
  */
 BOOL wm_get(WORD w_handle, WORD w_field, WORD *poutwds, WORD *pinwds)
 {
@@ -1560,6 +1607,11 @@ BOOL wm_get(WORD w_handle, WORD w_field, WORD *poutwds, WORD *pinwds)
         /* FIXME: GRECT typecasting again */
         w_owns(pwin, po, &t, (GRECT *)poutwds);
         break;
+    case WF_XRLIST:
+        w_getsize(WS_WORK, w_handle, &t);
+        poutwds[1] = w_allowns(pwin, &t, *(GRECT **)pinwds, pinwds[2]);
+        poutwds[0] = min(poutwds[1], max(pinwds[2], 0));
+        break;
     case WF_SCREEN:
         gsx_mret((LONG *)poutwds, (LONG *)(poutwds+2));
         break;
@@ -2,7 +2,7 @@
 *       gemwrect.c - AES window rectangle functions
 *
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2023 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -21,10 +21,10 @@
 #include "intmath.h"
 #include "gemlib.h"
 
-#include "gemobjop.h"
 #include "gemwmlib.h"
 #include "geminit.h"
 #include "gemwrect.h"
+#include "rectfunc.h"
 
 
 #define TOP     0
@@ -47,6 +47,16 @@ void or_start(void)
         D.g_olist[i].o_link = rul;
         rul = &D.g_olist[i];
     }
+
+    /* add the reserve allocated by gem_main(), if any */
+    if (D.g_oreserve)
+    {
+        for (i = 0; i < NUM_ORECT_RESERVE; i++)
+        {
+            D.g_oreserve[i].o_link = rul;
+            rul = &D.g_oreserve[i];
+        }
+    }
 }
 
 
@@ -66,6 +76,8 @@ static ORECT *mkpiece(WORD tlrb, ORECT *new, ORECT *old)
     ORECT *rl;
 
     rl = get_orect();
+    if (!rl)                /* out of orects: the piece is dropped */
+        return NULL;
     rl->o_link = old;
 
     /* do common calcs */
@@ -102,6 +114,7 @@ static ORECT *brkrct(ORECT *new, ORECT *r, ORECT *p)
 {
     WORD    i;
     WORD    have_piece[4];
+    ORECT   *piece;
 
     /* break up rectangle r based on new, adding new orects to list p */
     if ((new->o_gr.g_x < r->o_gr.g_x + r->o_gr.g_w) &&
@@ -118,7 +131,11 @@ static ORECT *brkrct(ORECT *new, ORECT *r, ORECT *p)
         for (i = 0; i < 4; i++)
         {
             if (have_piece[i])
-                p = (p->o_link = mkpiece(i, new, r));
+            {
+                piece = mkpiece(i, new, r);
+                if (piece)
+                    p = (p->o_link = piece);
+            }
         }
 
         /* take out the old guy */
@@ -132,8 +149,8 @@ static ORECT *brkrct(ORECT *new, ORECT *r, ORECT *p)
 }
 
 
-/* tree = place holder for everyobj */
-static void mkrect(OBJECT *tree, WORD wh)
+/* break window wh's rectangles with gl_mkrect */
+static void mkrect(WORD wh)
 {
     WINDOW  *pwin;
     ORECT   *new;
@@ -162,16 +179,17 @@ static void mkrect(OBJECT *tree, WORD wh)
 }
 
 
-void newrect(OBJECT *tree, WORD wh)
+/*
+ *  Give back a window's rectangle list
+ */
+void freerect(WORD wh)
 {
     WINDOW  *pwin;
-    ORECT   *r, *new;
-    ORECT   *r0;
+    ORECT   *r, *r0;
 
     pwin = &D.w_win[wh];
     r0 = pwin->w_rlist;
 
-    /* dump rectangle list */
     if (r0)
     {
         for (r = r0; r->o_link; r = r->o_link)
@@ -180,26 +198,100 @@ void newrect(OBJECT *tree, WORD wh)
         rul = r0;
     }
 
-    /* zero the rectangle list */
     pwin->w_rlist = NULL;
+}
+
+
+/*
+ *  Return the window above wh in the window tree, or NIL
+ */
+static WORD next_window(OBJECT *tree, WORD wh)
+{
+    WORD    next;
+
+    if (wh == ROOT)
+        return tree[ROOT].ob_head;
+
+    next = tree[wh].ob_next;
+
+    return (next == ROOT) ? NIL : next;
+}
+
+
+static BOOL overlap(GRECT *p1, GRECT *p2)
+{
+    if (!(p1->g_w && p1->g_h && p2->g_w && p2->g_h))
+        return FALSE;
+
+    return (p1->g_x < p2->g_x + p2->g_w) && (p2->g_x < p1->g_x + p1->g_w)
+        && (p1->g_y < p2->g_y + p2->g_h) && (p2->g_y < p1->g_y + p1->g_h);
+}
+
+
+/*
+ *  Rebuild the rectangle list of window wh: start with the whole window,
+ *  then break it with each of the windows above it
+ */
+static void newrect(OBJECT *tree, WORD wh)
+{
+    WINDOW  *pwin;
+    ORECT   *new;
+    WORD    above;
+
+    pwin = &D.w_win[wh];
+
+    /* dump rectangle list */
+    freerect(wh);
 
     /* start out with no broken rectangles */
     pwin->w_flags &= ~VF_BROKEN;
 
-    /* if no size then return */
+    /* if no size (or no orects left) then return */
     w_getsize(WS_TRUE, wh, &gl_mkrect.o_gr);
     if (!(gl_mkrect.o_gr.g_w && gl_mkrect.o_gr.g_h))
         return;
+    new = get_orect();
+    if (!new)
+        return;
+
+    new->o_link = NULL;
+    rc_copy(&gl_mkrect.o_gr, &new->o_gr);
+    pwin->w_rlist = new;
 
     /* init. a global orect for use during mkrect calls */
     gl_mkrect.o_link = NULL;
 
-    /* break other window's rects with our current rect */
-    everyobj(tree, ROOT, wh, (EVERYOBJ_CALLBACK)mkrect, 0, 0, MAX_DEPTH);
+    for (above = next_window(tree, wh); above != NIL; above = next_window(tree, above))
+    {
+        w_getsize(WS_TRUE, above, &gl_mkrect.o_gr);
+        if (gl_mkrect.o_gr.g_w && gl_mkrect.o_gr.g_h)
+            mkrect(wh);
+    }
+}
+
 
-    /* get an orect in this window's list */
-    new = get_orect();
-    new->o_link  = NULL;
-    w_getsize(WS_TRUE, wh, &new->o_gr);
-    pwin->w_rlist = new;
+/*
+ *  Update the rectangle lists after window wh has been opened, closed,
+ *  moved, sized or topped; pold points to its previous extent.
+ *
+ *  A window's list only depends on the windows above it that overlap it,
+ *  so only the lists of windows that overlap the old or the new extent
+ *  of wh need to be rebuilt.  The other lists stay as they are.
+ */
+void updrect(OBJECT *tree, WORD wh, GRECT *pold)
+{
+    GRECT   new, t;
+    WORD    i;
+
+    /* a window that has been closed doesn't need its list any more */
+    w_getsize(WS_TRUE, wh, &new);
+    if (!(new.g_w && new.g_h))
+        freerect(wh);
+
+    for (i = ROOT; i != NIL; i = next_window(tree, i))
+    {
+        w_getsize(WS_TRUE, i, &t);
+        if ((i == wh) || overlap(&t, pold) || overlap(&t, &new))
+            newrect(tree, i);
+    }
 }
@@ -1,7 +1,7 @@
 /*
  * gemwrect.h - header for EmuTOS AES window rectangle functions
  *
- * Copyright (C) 2002-2020 The EmuTOS development team
+ * Copyright (C) 2002-2026 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -12,6 +12,7 @@
 
 void or_start(void);
 ORECT *get_orect(void);
-void newrect(OBJECT *tree, WORD wh);
+void freerect(WORD wh);
+void updrect(OBJECT *tree, WORD wh, GRECT *pold);
 
 #endif
@@ -276,8 +276,12 @@ static const FND funcs[] =
     { F(xsfirst),  0, 3 },      /* 0x4E */
     { F(xsnext),   0, 0 },      /* 0x4F */
 
-    { NI, 0, 0 },               /* 0x50 */
-    { NI, 0, 0 },
+    { F(xsnextm),  0, 4 },      /* 0x50 - EmuTOS extension */
+#if CONF_WITH_MEMORY_STATS
+    { F(xmstat),   0, 3 },      /* 0x51 - EmuTOS extension */
+#else
+    { NI, 0, 0 },               /* 0x51 */
+#endif
     { NI, 0, 0 },
     { NI, 0, 0 },
     { NI, 0, 0 },
@@ -605,15 +609,16 @@ restrt:
 
                 pb2 = *pb;      /* char * is buffer address */
 
-                for (n = 0; n < count; n++)
+                if (num == H_Console)
                 {
-                    if (num == H_Console)
-                        tabout(HXFORM(num), (unsigned char)*pb2++);
-                    else
-                    {           /* M01.01.1029.01 */
-                        if (Bconout(HXFORM(num), (unsigned char)*pb2++) == 0)
-                            return n;
-                    }
+                    tabout_buf(HXFORM(num), pb2, count);
+                    return count;
+                }
+
+                for (n = 0; n < count; n++)
+                {               /* M01.01.1029.01 */
+                    if (Bconout(HXFORM(num), (unsigned char)*pb2++) == 0)
+                        return n;
                 }
 
                 return count;
@@ -23,6 +23,8 @@
 #include "console.h"
 #include "biosbind.h"
 #include "bdosstub.h"
+#include "biosext.h"
+#include "string.h"
 
 /*
  * The following structure is used for the typeahead buffer
@@ -303,6 +305,69 @@ void tabout(int h, int ch)
 }
 
 
+#if CONF_WITH_BLOCK_CONOUT
+/*
+ * blockout - output a run of printable characters in one BIOS call
+ *
+ * @h - device handle
+ * @p - characters, the first one must be printable
+ * @count - max number of characters
+ *
+ * returns the number of characters output
+ */
+static long blockout(int h, const char *p, long count)
+{
+    long i, n;
+
+    for (n = 1; (n < count) && ((unsigned char)p[n] >= ' '); n++)
+        ;
+
+    conbrk(h);                  /* check for control-s break, once */
+    if (bconws(h, p, n) < 0)
+    {
+        /* a hook has been installed meanwhile */
+        for (i = 0; i < n; i++)
+            conout(h, (unsigned char)p[i]);
+    }
+    else
+        glbcolumn[h] += n;
+
+    return n;
+}
+#endif
+
+
+/*
+ * tabout_buf - output a buffer to the console with tab expansion
+ *
+ * @h - device handle
+ * @p - characters
+ * @count - number of characters
+ */
+void tabout_buf(int h, const char *p, long count)
+{
+#if CONF_WITH_BLOCK_CONOUT
+    long n;
+    BOOL block = (bconws(h, p, 0L) == 0);   /* can the BIOS output runs? */
+#endif
+
+    while (count > 0)
+    {
+#if CONF_WITH_BLOCK_CONOUT
+        if (block && ((unsigned char)*p >= ' '))
+        {
+            n = blockout(h, p, count);
+            p += n;
+            count -= n;
+            continue;
+        }
+#endif
+        tabout(h, (unsigned char)*p++);
+        count--;
+    }
+}
+
+
 /*
  * cookdout - console output with tab and control character expansion
  *
@@ -467,8 +532,7 @@ void xconws(char *p)
  */
 static void prt_line(int h, char *p)
 {
-    while(*p)
-        tabout(h, (unsigned char)*p++);
+    tabout_buf(h, p, strlen(p));
 }
 
 
@@ -541,11 +605,24 @@ int cgets(int h, int maxlen, char *buf)
 {
     char ch;
     int i, stcol, retlen;
+#if CONF_WITH_FAST_LINE_INPUT
+    int start;
+    long pending = -1L;         /* control character read ahead, if >= 0 */
+#endif
 
     stcol = glbcolumn[h];       /* set up starting column */
     for (retlen = 0; retlen < maxlen; )
     {
-        switch(ch = getch(h))
+#if CONF_WITH_FAST_LINE_INPUT
+        if (pending >= 0)
+        {
+            ch = pending;
+            pending = -1L;
+        }
+        else
+#endif
+        ch = getch(h);
+        switch(ch)
         {
         case cr:
         case lf:
@@ -575,6 +652,31 @@ int cgets(int h, int maxlen, char *buf)
                 cookdout(h,(unsigned char)buf[i]);
             break;
         default:
+#if CONF_WITH_FAST_LINE_INPUT
+            /*
+             * store any further printable characters that are already
+             * available (e.g. pasted text) without waiting for the echo,
+             * then echo them all in one go.  the first control character
+             * found is handled by the next pass through the loop.
+             */
+            if ((unsigned char)ch >= ' ')
+            {
+                start = retlen;
+                buf[retlen++] = ch;
+                while ((retlen < maxlen) && constat(h))
+                {
+                    ch = getch(h);
+                    if (((unsigned char)ch < ' ') || (ch == rub))
+                    {
+                        pending = (unsigned char)ch;
+                        break;
+                    }
+                    buf[retlen++] = ch;
+                }
+                tabout_buf(h, buf+start, retlen-start);
+                break;
+            }
+#endif
             cookdout(h,(unsigned char)(buf[retlen++] = ch));
         }
     }
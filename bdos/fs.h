@@ -222,6 +222,7 @@ struct _dnd         /* directory node descriptor */
 
     long d_scan;        /*  current posn in dir for DND tree    */
     OFD  *d_files;      /* open files on this node              */
+    ULONG d_lru;        /* when last used, for discarding DNDs  */
 } ;
 
 /*
@@ -390,6 +391,9 @@ long ixcreat(char *name, UBYTE attr);
 /* open a file (path name) */
 long xopen(char *name, int mod);
 
+/* open a program file for Pexec() */
+long xopen_exec(char *name);
+
 /* Close a file */
 long xclose(int h);
 long ixclose(OFD *fd, int part);
@@ -453,6 +457,7 @@ long xchmod(char *p, int wrt, UBYTE mod);
 long ixsfirst(char *name, WORD att, DTAINFO *addr);
 long xsfirst(char *name, int att);
 long xsnext(void);
+long xsnextm(DIRENTRY *buf, long size);
 long xgsdtof(DOSTIME *buf, int h, int wrt);
 void builds(const char *s1 , char *s2 );
 long xrename(int n, char *p1, char *p2);
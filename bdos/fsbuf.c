@@ -22,6 +22,7 @@
 #include "string.h"
 #include "tosvars.h"
 #include "biosext.h"
+#include "ktrace.h"
 
 #define NUMBUFS 2       /* buffers per list */
 
@@ -173,6 +174,7 @@ doio:   for (p = *(q = phdr); p->b_link; p = *(q = &p->b_link))
         b->b_buftyp = buftype;
         b->b_bufdrv = dmd->m_drvnum;
         b->b_dm = dmd;
+        KTRACE(KT_GETBCB, dmd->m_drvnum, buftype, recnum, 0);
     }
     else
     {   /* use a buffer, but first validate media */
@@ -188,6 +190,7 @@ doio:   for (p = *(q = phdr); p->b_link; p = *(q = &p->b_link))
                 longjmp(errbuf,1);
             }
         }
+        KTRACE(KT_GETBCB, dmd->m_drvnum, buftype, recnum, 1);
     }
 
     /*
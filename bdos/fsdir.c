@@ -150,6 +150,7 @@ static DND *dcrack(const char **np);
 static int getpath(const char *p, char *d, int dirspec);
 static BOOL match(char *s1, char *s2);
 static void makbuf(FCB *f, DTAINFO *dt);
+static void makent(FCB *f, DIRENTRY *de);
 static DND *getdnd(char *n, DND *d);
 static void snipdnd(DND *dnd);
 static void freednd(DND *dn);
@@ -171,6 +172,11 @@ static const char dots[22] = ".          ";
  */
 static LONG freed_dnds, freed_ofds; /* count of DNDs & OFDs made available */
 
+/*
+ *  incremented every time a DND is used, see free_available_dnds()
+ */
+static ULONG dnd_clock;
+
 
 /*
  *  namlen - parameter points to a character string of FNAMELEN bytes max
@@ -529,9 +535,17 @@ long xsfirst(char *name, int att)
 
 
 /*
- * ixsnext - does the heavy lifting for Fsnext()
+ * ixsnext - does the heavy lifting for Fsnext() and Fsnextm()
+ *
+ * finds up to 'max' further entries matching the search described by
+ * the private area of the DTA, and updates the private area.  if 'list'
+ * is NULL, the (single) entry found is stored in the public area of the
+ * DTA, otherwise the entries are stored in successive elements of 'list'.
+ *
+ * returns the number of entries found; if this is less than 'max', the
+ * end of the directory has been reached.
  */
-static FCB *ixsnext(DTAINFO *dt)
+static WORD ixsnext(DTAINFO *dt, DIRENTRY *list, WORD max)
 {
     char name[FNAMELEN+1];
     UBYTE *buf, *bufend;
@@ -544,7 +558,7 @@ static FCB *ixsnext(DTAINFO *dt)
 
     drive = dt->dt_offset_drive & DTA_DRIVEMASK;
     if (drive >= BLKDEVNUM)
-        return NULL;
+        return 0;
 
     builds(dt->dt_name,name);   /* build FCB-style name */
     name[FNAMELEN] = dt->dt_attr;
@@ -571,11 +585,12 @@ static FCB *ixsnext(DTAINFO *dt)
         offset &= dmd->m_rbm;           /* within record */
     }
 
-    KDEBUG(("ixsnext(%p): drv=%d,buftype=%d,recnum=%ld,offset=%ld\n",
-            dt,drive,buftype,recnum,offset));
+    KDEBUG(("ixsnext(%p): drv=%d,buftype=%d,recnum=%ld,offset=%ld,max=%d\n",
+            dt,drive,buftype,recnum,offset,max));
 
     /*
-     * search directory
+     * search directory.  all the matching entries within a record
+     * are handled with a single buffer lookup.
      */
     found = 0;
     while(1)
@@ -583,7 +598,7 @@ static FCB *ixsnext(DTAINFO *dt)
         if (buftype == BT_ROOT)
         {
             if (recnum >= rootdirlen)       /* end of root */
-                break;
+                return found;
         }
         else
         {
@@ -591,7 +606,7 @@ static FCB *ixsnext(DTAINFO *dt)
             {
                 cluster = getrealcl(cluster,dmd);
                 if (endofchain(cluster))    /* end of directory */
-                    break;
+                    return found;
                 recnum = cl2rec(cluster,dmd);
             }
         }
@@ -601,19 +616,22 @@ static FCB *ixsnext(DTAINFO *dt)
         bufend = buf + dmd->m_recsiz;
         for (fcb = (FCB *)(buf+offset); fcb < (FCB *)bufend; fcb++) {
             if (fcb->f_name[0] == 0x00)     /* never used, so must be end */
-                return NULL;
-            if ((found = match(name,fcb->f_name)))
+                return found;
+            if (!match(name,fcb->f_name))
+                continue;
+            if (list)
+                makent(fcb,list++);
+            else
+                makbuf(fcb,dt);
+            if (++found >= max)
                 break;
         }
-        if (found)
+        if (found >= max)
             break;
         recnum++;
         offset = 0;
     }
 
-    if (!found)
-        return NULL;
-
     /*
      * update the private area
      */
@@ -629,7 +647,7 @@ static FCB *ixsnext(DTAINFO *dt)
         dt->dt_clnum = cluster;
     }
 
-    return fcb;
+    return found;
 }
 
 
@@ -642,7 +660,6 @@ static FCB *ixsnext(DTAINFO *dt)
  */
 long xsnext(void)
 {
-    FCB *fcb;
     DTAINFO *dt;
 
     dt = (DTAINFO *)run->p_xdta;            /* M01.01.1209.01 */
@@ -651,20 +668,57 @@ long xsnext(void)
     if (dt->dt_offset_drive < 0L)
         return ENMFIL;
 
-    fcb = ixsnext(dt);
-
-    if (fcb == NULL)                        /* end of directory */
+    if (ixsnext(dt, NULL, 1) == 0)          /* end of directory */
     {
         dt->dt_offset_drive = -1L;
         return ENMFIL;
     }
 
-    makbuf(fcb,(DTAINFO *)run->p_xdta);
-
     return E_OK;
 }
 
 
+/*
+ *  xsnextm - search next, returning as many entries as fit into buf
+ *
+ *  Function 0x50   f_snextm (EmuTOS extension)
+ *
+ *  This continues the search started by Fsfirst(), exactly like
+ *  repeated calls to Fsnext() would do, but returns the entries as a
+ *  packed array of DIRENTRY, whose layout matches the end of the DTA.
+ *  The current DTA is used to hold the search state, so it serves as
+ *  the resumable cookie: callers may alternate between Fsnext() and
+ *  Fsnextm(), and may run several searches by switching DTAs.
+ *
+ *  Returns the number of entries stored (> 0)
+ *  Error returns:  ENMFIL, ERANGE (buffer too small for one entry)
+ */
+long xsnextm(DIRENTRY *buf, long size)
+{
+    DTAINFO *dt;
+    long max;
+    WORD n;
+
+    dt = (DTAINFO *)run->p_xdta;
+
+    max = size / sizeof(DIRENTRY);
+    if (max <= 0)
+        return ERANGE;
+    if (max > 0x7fff)
+        max = 0x7fff;
+
+    /* has the DTA been initialized? */
+    if (dt->dt_offset_drive < 0L)
+        return ENMFIL;
+
+    n = ixsnext(dt, buf, max);
+    if (n < max)                            /* end of directory */
+        dt->dt_offset_drive = -1L;
+
+    return n ? n : ENMFIL;
+}
+
+
 /*
  *  xgsdtof - get/set date/time of file into or from buffer
  *
@@ -1473,6 +1527,8 @@ DND *findit(char *name, const char **sp, int dflag)
             else
                 p = newp;
         }
+        if (p)
+            p->d_lru = ++dnd_clock;
 
     scanxt:
     if (*(n = n + i))
@@ -1598,14 +1654,25 @@ FCB *scan(DND *dnd, const char *n, WORD att, LONG *posp)
  */
 static DND *makdnd(DND *p, FCB *fcb)
 {
-    DIRTBL_ENTRY *dt;
     DND *p1;
-    DND **prev;
     OFD *fd;
+    UWORD flag;
+#if !OSMEM_MAX_BLOCKS
+    DIRTBL_ENTRY *dt;
+    DND **prev;
     int i;
+#endif
 
     fd = p->d_ofd;
 
+#if OSMEM_MAX_BLOCKS
+    /*
+     *  the os memory pool can grow, so we keep the DNDs at this level as
+     *  a cache: free_available_dnds() discards the least recently used
+     *  ones when memory is really short
+     */
+    p1 = NULL;
+#else
     /*
      *  scavenge a DND at this level if we can find one that has not
      *  d_left
@@ -1638,6 +1705,7 @@ static DND *makdnd(DND *p, FCB *fcb)
             }
         }
     }
+#endif
 
     /* we didn't find one that qualifies, so allocate a new one */
 
@@ -1645,7 +1713,14 @@ static DND *makdnd(DND *p, FCB *fcb)
     {
         KDEBUG(("\n makdnd new"));
 
+        /*
+         * if we run out of memory, xmgetblk() will run free_available_dnds(),
+         * which must not free the DND we're scanning
+         */
+        flag = p->d_flag;
+        p->d_flag |= DND_LOCKED;
         p1 = MGET(DND); /* MGET(DND) only returns if it succeeds */
+        p->d_flag = flag;
 
         /* do this init only on a newly allocated DND */
         p1->d_right = p->d_left;
@@ -1664,6 +1739,7 @@ static DND *makdnd(DND *p, FCB *fcb)
     p1->d_td.time = fcb->f_td.time; /* note: DND time/date are  */
     p1->d_td.date = fcb->f_td.date; /*  actually little-endian! */
     memcpy(p1->d_name, fcb->f_name, FNAMELEN);
+    p1->d_lru = ++dnd_clock;
 
     KDEBUG(("\n makdnd(%p)",p1));
 
@@ -1851,6 +1927,24 @@ static void makbuf(FCB *f, DTAINFO *dt)
 }
 
 
+/*
+ *  makent - copy info from FCB into a DIRENTRY for Fsnextm()
+ */
+static void makent(FCB *f, DIRENTRY *de)
+{
+    de->d_resvd = 0;
+    de->d_attrib = f->f_attrib;
+    de->d_time = f->f_td.time;
+    swpw(de->d_time);
+    de->d_date = f->f_td.date;
+    swpw(de->d_date);
+    de->d_length = f->f_fileln;
+    swpl(de->d_length);
+
+    packit(f->f_name,de->d_fname);
+}
+
+
 
 /*
  *  getdnd - find a DND with matching name
@@ -1941,121 +2035,104 @@ OFD *makofd(DND *p)
 
 
 /*
- * function used by free_available_dnds()
+ * return TRUE iff the DND may be freed by free_available_dnds()
  */
-static void process_dnd_tree(DND *dndstart)
+static BOOL dnd_freeable(DND *dnd)
 {
-    DND *dnd, *prev;
     DIRTBL_ENTRY *dt;
     WORD i;
 
     /*
-     * follow the sibling chain
+     * not if it has children, open files, or is a root directory
      */
-    for (dnd = dndstart, prev = NULL; dnd; dnd = dnd->d_right) {
-        /*
-         * if child exists, first process the tree based on that child
-         */
-        if (dnd->d_left)
-            process_dnd_tree(dnd->d_left);
-
-        /*
-         * check again, since above we may have freed up the entire child tree
-         */
-        if (dnd->d_left) {
-            KDEBUG(("DND at %p has children\n",dnd));
-            prev = dnd;
-            continue;
-        }
+    if (dnd->d_left || dnd->d_files || !dnd->d_parent)
+        return FALSE;
 
-        /*
-         * no children - but are there open files?
-         */
-        if (dnd->d_files) {     /* open files in this directory, can't free DND */
-            KDEBUG(("DND at %p has open files\n",dnd));
-            prev = dnd;
-            continue;
-        }
+    /*
+     * not if it is locked
+     */
+    if (dnd->d_flag&DND_LOCKED)
+        return FALSE;
 
-        /*
-         * no open files - but is this anyone's current dir?
-         */
-        for (i = 1, dt = dirtbl+1; i < NCURDIR; i++, dt++)
-            if (dt->use && (dt->dnd == dnd))
-                break;
-        if (i < NCURDIR) {      /* it's someone's current directory */
-            KDEBUG(("DND at %p is a current directory\n",dnd));
-            prev = dnd;
-            continue;
-        }
+    /*
+     * not if it's anyone's current dir
+     */
+    for (i = 1, dt = dirtbl+1; i < NCURDIR; i++, dt++)
+        if (dt->use && (dt->dnd == dnd))
+            return FALSE;
 
-        /*
-         * not current - but are we at the root?
-         */
-        if (!dnd->d_parent) {
-            KDEBUG(("DND at %p is a root directory\n",dnd));
-            prev = dnd;
-            continue;
-        }
+    return TRUE;
+}
 
-        /*
-         * not at the root - but are we locked?
-         */
-        if (dnd->d_flag&DND_LOCKED) {
-            KDEBUG(("DND at %p is locked\n",dnd));
-            prev = dnd;
-            continue;
-        }
 
-        /*
-         * we've got a freeable DND
-         *
-         * if there was a previous sibling, link it to the next
-         * else point the parent to the next & say there's no previous
-         */
-        if (prev) {
-            prev->d_right = dnd->d_right;
-        } else {
-            dnd->d_parent->d_left = dnd->d_right;
-            prev = NULL;
-        }
+/*
+ * function used by free_available_dnds(): find the least recently used
+ * freeable DND in the tree starting at 'dndstart'
+ */
+static DND *lru_dnd(DND *dndstart, DND *best)
+{
+    DND *dnd;
 
-        /*
-         * now we can free up the DND and any associated OFD
-         */
-        if (dnd->d_ofd) {
-            xmfreblk(dnd->d_ofd);
-            freed_ofds++;
-        }
-        xmfreblk(dnd);
-        freed_dnds++;
+    /*
+     * follow the sibling chain, then the children of each sibling
+     */
+    for (dnd = dndstart; dnd; dnd = dnd->d_right)
+    {
+        if (dnd->d_left)
+            best = lru_dnd(dnd->d_left, best);
+        else if (dnd_freeable(dnd) && (!best || (dnd->d_lru < best->d_lru)))
+            best = dnd;
     }
+
+    return best;
 }
 
 
 /*
  * the following routine is called (by xmgetblk() in osmem.c) when we
- * cannot get memory for a DND or OFD.  it calls process_dnd_tree() to
- * free up DNDs that are not absolutely required (this is the same idea
- * as the "scavenge" procedure in makdnd() above).
+ * cannot get memory for a DND or OFD.  it frees up to MAX_FREED_DNDS
+ * DNDs that are not absolutely required, least recently used first, so
+ * that the DND tree remains useful as a cache of the directory structure.
+ * a DND is only freed when it has no children, so parents are freed after
+ * their children.
  */
+#define MAX_FREED_DNDS  8
+
 WORD free_available_dnds(void)
 {
     DMD *dmd;
+    DND *dnd;
     WORD i;
 
     KDEBUG(("free_available_dnds() called\n"));
     freed_dnds = freed_ofds = 0L;
 
-    /*
-     * process all DMDs
-     */
-    for (i = 0; i < BLKDEVNUM; i++) {
-        dmd = drvtbl[i];
-        if (!dmd)
-            continue;
-        if (dmd->m_dtl)
-            process_dnd_tree(dmd->m_dtl);
+    while (freed_dnds < MAX_FREED_DNDS)
+    {
+        /*
+         * process all DMDs
+         */
+        for (i = 0, dnd = NULL; i < BLKDEVNUM; i++) {
+            dmd = drvtbl[i];
+            if (!dmd)
+                continue;
+            if (dmd->m_dtl)
+                dnd = lru_dnd(dmd->m_dtl, dnd);
+        }
+        if (!dnd)
+            break;
+
+        /*
+         * free up the DND and any associated OFD
+         */
+        KDEBUG(("freeing DND at %p\n",dnd));
+        snipdnd(dnd);
+        if (dnd->d_ofd) {
+            xmfreblk(dnd->d_ofd);
+            freed_ofds++;
+        }
+        xmfreblk(dnd);
+        freed_dnds++;
     }
 
     KDEBUG(("freed %ld DNDs, %ld OFDs\n",freed_dnds,freed_ofds));
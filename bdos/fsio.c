@@ -17,6 +17,7 @@
 #include "string.h"
 #include "tosvars.h"
 #include "intmath.h"
+#include "biosext.h"
 
 
 #define CNTMAX  0x7FFFul  /* 16-bit MAXINT */
@@ -448,6 +449,11 @@ long xread(int h, long len, void *ubufr)
     else
         ret = EIHNDL;
 
+#if CONF_WITH_IO_STATS
+    if (ret > 0)
+        iostats.bytes_read += ret;
+#endif
+
     KDEBUG(("xread(%d,%ld): rc=%ld\n",h,len,ret));
 
     return ret;
@@ -542,6 +548,11 @@ long xwrite(int h, long len, void *ubufr)
     else
         ret = EIHNDL;
 
+#if CONF_WITH_IO_STATS
+    if (ret > 0)
+        iostats.bytes_written += ret;
+#endif
+
     KDEBUG(("xwrite(%d,%ld): rc=%ld\n",h,len,ret));
 
     return ret;
@@ -229,6 +229,34 @@ long xopen(char *name, int mod)
     return rc;
 }
 
+/*
+ *  xopen_exec - open a program file for Pexec()
+ *
+ *  The file is looked up only once, and must match the same attributes
+ *  as Fsfirst(name,0) would: hidden and system files are not found.
+ *
+ *  Error returns   EFILNF, opnfil()
+ *
+ *  +ve return      file handle
+ */
+long xopen_exec(char *name)
+{
+    FCB *fcb;
+    DND *dn;
+    const char *s;
+    long pos;
+
+    dn = findit(name,&s,0);
+    if (!dn)
+        return EFILNF;
+
+    pos = 0;
+    if (!(fcb = scan(dn,s,FA_ARCHIVE|FA_RO,&pos)))
+        return EFILNF;
+
+    return opnfil(fcb, dn, RO_MODE);
+}
+
 /*
 **  ixopen - open a file
 **
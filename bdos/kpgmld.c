@@ -20,6 +20,7 @@
 #include "gemerror.h"
 #include "pghdr.h"
 #include "string.h"
+#include "tosvars.h"
 
 
 /*
@@ -29,6 +30,11 @@
 static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd);
 static LONG pgfix01(UBYTE *lastcp, LONG nrelbytes, PGMINFO *pi);
 
+#if CONF_WITH_KTRACE
+ULONG pgmld_reloc_ticks;
+ULONG pgmld_clear_ticks;
+#endif
+
 /*
  * kpgmhdrld - load program header
  *
@@ -152,6 +158,10 @@ static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd)
     if (r < 0)
         return r;
 
+#if CONF_WITH_KTRACE
+    pgmld_reloc_ticks = hz_200;
+#endif
+
     if (!hd->h01_abs)
     {
 
@@ -207,6 +217,10 @@ static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd)
 
     }
 
+#if CONF_WITH_KTRACE
+    pgmld_clear_ticks = hz_200;
+#endif
+
     /* clear the bss or the whole heap */
 
     if (hd->h01_flags & PF_FASTLOAD)
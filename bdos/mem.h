@@ -56,6 +56,11 @@ void xmfremd(MD *md);       /* xmfremd - free an MD */
 /* init os memory */
 void osmem_init(void);
 
+#if CONF_WITH_MEMORY_STATS
+/* fill in the OS pool statistics */
+void osmem_stat(MSTAT *ms);
+#endif
+
 /*
  * in umem.c
  */
@@ -69,6 +74,11 @@ long xsetblk(int n, void *blk, long len);
 /* mxalloc */
 void *xmxalloc(long amount, int mode);
 
+#if CONF_WITH_MEMORY_STATS
+/* mstat */
+long xmstat(WORD pool, MSTAT *ms);
+#endif
+
 #if CONF_WITH_VIDEL
 /* srealloc */
 void *srealloc(long amount);
@@ -80,6 +90,11 @@ void umem_init(void);
 /* set memory ownership */
 void set_owner(void *addr, PD *p);
 
+#if OSMEM_MAX_BLOCKS
+/* allocate memory for the OS pool, never freed */
+void *xmalloc_os(long amount);
+#endif
+
 
 /*
  * in iumem.c
@@ -79,6 +79,10 @@ WORD *root[MAXQUICK];
 
 static MDBLOCK *mdbroot;    /* root for partially-used MDBLOCKs */
 
+#if OSMEM_MAX_BLOCKS
+static WORD osmadded;       /* number of blocks added by grow_osm() */
+#endif
+
 
 /*
  *  local debug counters
@@ -115,6 +119,42 @@ static WORD *getosm(WORD n)
 }
 
 
+#if OSMEM_MAX_BLOCKS
+/*
+ * grow_osm - add OSMEM_GROW_BLOCKS blocks from user memory to the free
+ * list, unless OSMEM_MAX_BLOCKS blocks have already been added
+ *
+ * this is called while the os memory pool still has a block left, since
+ * allocating the user memory may require an MD
+ */
+static void grow_osm(void)
+{
+    WORD *m;
+    WORD i, n;
+
+    n = OSMEM_MAX_BLOCKS - osmadded;
+    if (n > OSMEM_GROW_BLOCKS)
+        n = OSMEM_GROW_BLOCKS;
+    if (n <= 0)
+        return;
+
+    m = xmalloc_os((LONG)n * LEN_OSM_BLOCK);
+    if (!m)
+        return;
+
+    KDEBUG(("grow_osm(): adding %d blocks at %p\n",n,m));
+    osmadded += n;
+
+    /* format the blocks like getosm() & xmgetblk() do, then free them */
+    for (i = 0; i < n; i++, m += LEN_OSM_BLOCK/sizeof(WORD))
+    {
+        *m = 4;                 /* size index in control word */
+        xmfreblk(m+1);
+    }
+}
+#endif
+
+
 /*
  *  unlink_mdblock - unlinks an MDBLOCK from the mdb chain
  *
@@ -285,6 +325,9 @@ void xmfremd(MD *md)
  * will fail).  Otherwise we will attempt to free up DNDs to make space
  * and if that fails, the system will be halted.
  *
+ * If OSMEM_MAX_BLOCKS is nonzero, the pool is grown from user memory
+ * when it is nearly exhausted, and DNDs are freed only if that fails.
+ *
  * Arguments:
  *  memtype: the type of request
  */
@@ -310,6 +353,12 @@ void *xmgetblk(WORD memtype)
      */
     for (j = 0; ; j++)
     {
+#if OSMEM_MAX_BLOCKS
+        /* keep the last block of the pool for the MD needed to grow it */
+        if (!root[i] && (osmlen < 2*(w+1)) && (memtype != MEMTYPE_MDBLOCK))
+            grow_osm();
+#endif
+
         if ( *(r = &root[i]) )      /* there is an item on the free list */
         {
             m = *r;                 /* get first item on list   */
@@ -384,6 +433,30 @@ void xmfreblk(void *m)
 }
 
 
+#if CONF_WITH_MEMORY_STATS
+/*
+ * fill in the OS pool statistics for Mstat()
+ */
+void osmem_stat(MSTAT *ms)
+{
+    WORD *m;
+    LONG carved, unused;
+
+    carved = osmptr / (LEN_OSM_BLOCK/sizeof(WORD));
+    for (m = root[4], unused = 0; m; m = *((WORD **)m))
+        unused++;
+
+    ms->ms_osmtotal = NUM_OSM_BLOCKS;
+#if OSMEM_MAX_BLOCKS
+    carved += osmadded;
+    ms->ms_osmtotal += osmadded;
+#endif
+    ms->ms_osmused = carved - unused;
+    ms->ms_osmfails = dbggtosm;
+}
+#endif
+
+
 /*
  * called by bdosmain to initialise the OS memory pool
  */
@@ -391,6 +464,9 @@ void osmem_init(void)
 {
     osmlen = LENOSM;
     mdbroot = NULL;
+#if OSMEM_MAX_BLOCKS
+    osmadded = 0;
+#endif
     dbgfreblk = 0;
     dbggtosm = 0;
     dbggtblk = 0;
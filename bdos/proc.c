@@ -26,6 +26,8 @@
 #include "biosext.h"
 #include "asm.h"
 #include "has.h"
+#include "ktrace.h"
+#include "tosvars.h"
 
 
 /*
@@ -42,6 +44,7 @@ static WORD envsize( char *env );
 static void init_pd_fields(PD *p, char *tail, long max, char *envptr);
 static void init_pd_files(PD *p);
 static char *alloc_env(ULONG flags, char *v);
+static void free_env(char *env);
 static UBYTE *alloc_tpa(ULONG flags,LONG needed,LONG *avail);
 static void proc_go(PD *p);
 
@@ -57,6 +60,9 @@ PD      *run;           /* ptr to PD for current process */
 
 static WORD    supstk[SUPSIZ]; /* common sup stack for all processes */
 static jmp_buf bakbuf;         /* longjmp buffer */
+#if CONF_WITH_SHARED_ENV
+static char empty_env[2];       /* for a resident process, if out of memory */
+#endif
 
 
 /*
@@ -175,6 +181,27 @@ static WORD envsize(char *env)
  * variable `foo' might be clobbered by `longjmp' or `vfork'
  */
 static PD *cur_p;
+#if CONF_WITH_KTRACE
+static ULONG start_ticks;       /* hz_200 when Pexec() started */
+static ULONG opened_ticks;      /* hz_200 when the program file was opened */
+static ULONG loaded_ticks;      /* hz_200 when the program was loaded */
+
+/*
+ * record the time spent in each phase of Pexec(), in hz_200 ticks:
+ * file lookup, load (header, memory allocation, text & data),
+ * relocation, clearing the bss/heap, and setting up the process
+ */
+static void trace_pexec_times(PD *p)
+{
+    ULONG lookup = opened_ticks - start_ticks;
+    ULONG load = pgmld_reloc_ticks - opened_ticks;
+    ULONG reloc = pgmld_clear_ticks - pgmld_reloc_ticks;
+    ULONG clear = loaded_ticks - pgmld_clear_ticks;
+
+    KTRACE(KT_PEXEC_TIMES, p, (lookup << 16) | (UWORD)load,
+            (reloc << 16) | (UWORD)clear, hz_200 - loaded_ticks);
+}
+#endif
 
 long xexec(WORD flag, char *path, char *tail, char *env)
 {
@@ -255,18 +282,21 @@ long xexec(WORD flag, char *path, char *tail, char *env)
 
     /* we now need to load a file */
     KDEBUG(("BDOS xexec: trying to find %s\n",path));
-    if (ixsfirst(path,0,0L)) {
-        KDEBUG(("BDOS xexec: command %s not found!!!\n",path));
-        return EFILNF;      /*  file not found      */
-    }
+#if CONF_WITH_KTRACE
+    ktrace_file(KT_PEXEC, flag, path, 0);
+    start_ticks = hz_200;
+#endif
 
-    /* attempt to open the file */
-    rc = xopen(path, 0);
+    /* find & open the file, with a single lookup of the path */
+    rc = xopen_exec(path);
     if (rc < 0) {
         KDEBUG(("BDOS xexec: cannot open %s\n",path));
         return rc;
     }
     fh = (FH) rc;
+#if CONF_WITH_KTRACE
+    opened_ticks = hz_200;
+#endif
 
     /* load the header - if I/O error occurs now, the longjmp in rwabs will
      * jump directly back to bdosmain.c, which is not a problem because
@@ -280,6 +310,15 @@ long xexec(WORD flag, char *path, char *tail, char *env)
     }
 
     /* allocate the environment first, depending on memory policy */
+#if CONF_WITH_SHARED_ENV
+    /*
+     * the parent is suspended until the child terminates, so the child
+     * can use the parent's environment rather than a copy of it
+     */
+    if ((flag == PE_LOADGO) && (env == NULL))
+        env_ptr = run->p_env;
+    else
+#endif
     env_ptr = alloc_env(hdr.h01_flags, env);
     if (env_ptr == NULL) {
         KDEBUG(("BDOS xexec: no memory for environment\n"));
@@ -294,7 +333,7 @@ long xexec(WORD flag, char *path, char *tail, char *env)
     /* if failed, free env_ptr and return */
     if (p == NULL) {
         KDEBUG(("BDOS xexec: no memory for TPA\n"));
-        xmfree(env_ptr);
+        free_env(env_ptr);
         xclose(fh);
         return ENSMEM;
     }
@@ -304,7 +343,8 @@ long xexec(WORD flag, char *path, char *tail, char *env)
      */
     owner = (flag == PE_LOADGO) ? p : run;
     set_owner(p, owner);
-    set_owner(env_ptr, owner);
+    if (env_ptr != run->p_env)
+        set_owner(env_ptr, owner);
 
     /* initialize the fields in the PD structure */
     init_pd_fields(p, tail, max, env_ptr);
@@ -322,7 +362,7 @@ long xexec(WORD flag, char *path, char *tail, char *env)
         KDEBUG(("Error and longjmp in xexec()!\n"));
 
         /* free any memory allocated so far & close the file */
-        xmfree(cur_p->p_env);
+        free_env(cur_p->p_env);
         xmfree(cur_p);
         xclose(fh);
 
@@ -337,11 +377,14 @@ long xexec(WORD flag, char *path, char *tail, char *env)
     if (rc) {
         KDEBUG(("BDOS xexec: kpgmld returned %ld (0x%lx)\n",rc,rc));
         /* free any memory allocated yet */
-        xmfree(cur_p->p_env);
+        free_env(cur_p->p_env);
         xmfree(cur_p);
 
         return rc;
     }
+#if CONF_WITH_KTRACE
+    loaded_ticks = hz_200;
+#endif
 
     /* at this point the program has been correctly loaded in memory, and
      * more I/O errors cannot occur, so it is safe now to finish initializing
@@ -355,6 +398,11 @@ long xexec(WORD flag, char *path, char *tail, char *env)
      */
     invalidate_instruction_cache(((UBYTE *)cur_p) + sizeof(PD), hdr.h01_tlen);
 
+    KTRACE(KT_PEXEC_LOADED, cur_p, hdr.h01_tlen, 0, 0);
+#if CONF_WITH_KTRACE
+    trace_pexec_times(cur_p);
+#endif
+
     if (flag != PE_LOAD)
         proc_go(cur_p);
     return (long)cur_p;
@@ -430,6 +478,26 @@ static char *alloc_env(ULONG flags, char *env)
     return new_env;
 }
 
+/*
+ * free the environment of a process that could not be loaded, unless it
+ * is shared with the current process
+ */
+static void free_env(char *env)
+{
+    if (env != run->p_env)
+        xmfree(env);
+}
+
+#if CONF_WITH_SHARED_ENV
+/*
+ * return TRUE iff the process uses the environment of its parent
+ */
+BOOL env_is_shared(const PD *p)
+{
+    return p->p_parent && (p->p_env == p->p_parent->p_env);
+}
+#endif
+
 /*
  * allocate the TPA
  *
@@ -603,6 +671,8 @@ void xterm(UWORD rc)
     PFVOID userterm;
     PD *p = run;
 
+    KTRACE(KT_PTERM, p, rc, 0, 0);
+
     userterm = (PFVOID)Setexc(0x102, (long)-1L);  /* get user term handler address */
     protect_v((PFLONG)userterm);    /* call it, protecting d2/a2 from modification */
 
@@ -625,6 +695,18 @@ WORD xtermres(long blkln, WORD rc)
 {
     xsetblk(0,run,blkln);
 
+#if CONF_WITH_SHARED_ENV
+    /*
+     * the parent's environment is freed when the parent terminates,
+     * so a resident process needs its own copy
+     */
+    if (env_is_shared(run))
+    {
+        char *env = alloc_env(run->p_flags, run->p_env);
+        run->p_env = env ? env : empty_env;
+    }
+#endif
+
     reserve_blocks(run, &pmd);
 #if CONF_WITH_ALT_RAM
     if (has_alt_ram)
@@ -27,6 +27,9 @@ long xexec(WORD, char *, char *, char *);
 void x0term(void);
 void xterm(UWORD rc)  NORETURN ;
 WORD xtermres(long blkln, WORD rc);
+#if CONF_WITH_SHARED_ENV
+BOOL env_is_shared(const PD *p);
+#endif
 
 /*
  * in kpgmld.c
@@ -34,6 +37,10 @@ WORD xtermres(long blkln, WORD rc);
 
 LONG kpgmhdrld(FH h, PGMHDR01 *hd);
 LONG kpgmld(PD *p, FH h, PGMHDR01 *hd);
+#if CONF_WITH_KTRACE
+extern ULONG pgmld_reloc_ticks; /* hz_200 when relocation started */
+extern ULONG pgmld_clear_ticks; /* hz_200 when clearing the bss started */
+#endif
 
 #if DETECT_NATIVE_FEATURES
 LONG kpgm_relocate( PD *p, long length); /* SOP */
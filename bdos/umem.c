@@ -19,6 +19,7 @@
 #include "bdosdefs.h"
 #include "fs.h"
 #include "mem.h"
+#include "proc.h"
 #include "gemerror.h"
 #include "biosbind.h"
 #include "biosext.h"
@@ -27,6 +28,7 @@
 #include "cookie.h"
 #include "string.h"
 #include "has.h"        /* for has_videl */
+#include "ktrace.h"
 
 
 /*
@@ -139,6 +141,12 @@ long xmfree(void *addr)
 
     KDEBUG(("BDOS: Mfree(%p)\n",addr));
 
+#if CONF_WITH_SHARED_ENV
+    /* the environment shared with the parent is not ours to free */
+    if ((addr == run->p_env) && env_is_shared(run))
+        return E_OK;
+#endif
+
     mpb = find_mpb(addr);
     if (!mpb)
         return EIMBA;
@@ -159,6 +167,103 @@ long xmfree(void *addr)
 }
 
 
+#if CONF_WITH_MEMORY_STATS
+/*
+ * add an allocated block to the per-process totals
+ *
+ * owners that don't fit in ms_owner[] are counted together in the last
+ * entry, with a NULL owner
+ */
+static void add_owner(MSTAT *ms, const MD *m)
+{
+    MSTATOWNER *o;
+    WORD i;
+
+    for (i = 0, o = ms->ms_owner; i < ms->ms_owners; i++, o++)
+        if (o->o_pd == m->m_own)
+            break;
+
+    if (i == ms->ms_owners)
+    {
+        if (i >= MSTAT_OWNERS-1)
+        {
+            o = &ms->ms_owner[MSTAT_OWNERS-1];
+            o->o_pd = NULL;
+            ms->ms_owners = MSTAT_OWNERS;
+        }
+        else
+        {
+            o->o_pd = m->m_own;
+            ms->ms_owners++;
+        }
+    }
+
+    o->o_blocks++;
+    o->o_bytes += m->m_length;
+}
+
+
+/*
+ *  xmstat - Function 0x51 (Mstat, EmuTOS extension)
+ *
+ *  Returns statistics about the ST RAM pool (pool == MSTAT_ST) or the
+ *  alternate RAM pool (pool == MSTAT_ALT), and the OS internal pool.
+ *  This allows to see whether a failing Malloc() is due to fragmentation,
+ *  and which processes own the memory.
+ *
+ *  Error returns:  ERANGE (invalid pool, or no alternate RAM)
+ */
+long xmstat(WORD pool, MSTAT *ms)
+{
+    MPB *mpb;
+    MD *m;
+    LONG limit;
+    WORD i;
+
+    switch(pool) {
+    case MSTAT_ST:
+        mpb = &pmd;
+        break;
+#if CONF_WITH_ALT_RAM
+    case MSTAT_ALT:
+        if (has_alt_ram)
+        {
+            mpb = &pmdalt;
+            break;
+        }
+        FALLTHROUGH;
+#endif
+    default:
+        return ERANGE;
+    }
+
+    bzero(ms, sizeof(MSTAT));
+
+    for (m = mpb->mp_mfl; m; m = m->m_link)
+    {
+        ms->ms_freeblocks++;
+        ms->ms_freebytes += m->m_length;
+        if (m->m_length > ms->ms_largest)
+            ms->ms_largest = m->m_length;
+        for (i = 0, limit = 1024L; (i < MSTAT_BUCKETS-1) && (m->m_length >= limit); i++)
+            limit <<= 2;
+        ms->ms_hist[i]++;
+    }
+
+    for (m = mpb->mp_mal; m; m = m->m_link)
+    {
+        ms->ms_usedblocks++;
+        ms->ms_usedbytes += m->m_length;
+        add_owner(ms, m);
+    }
+
+    osmem_stat(ms);
+
+    return E_OK;
+}
+#endif
+
+
 /*
  * xsetblk - Function 0x4A (Mshrink)
  *
@@ -174,6 +279,12 @@ long xsetblk(int n, void *blk, long len)
 
     KDEBUG(("BDOS: Mshrink(%p,%ld)\n",blk,len));
 
+#if CONF_WITH_SHARED_ENV
+    /* the environment shared with the parent must not change size */
+    if ((blk == run->p_env) && env_is_shared(run))
+        return EACCDN;
+#endif
+
     mpb = find_mpb(blk);
     if (!mpb)
         return EIMBA;
@@ -329,6 +440,7 @@ void *xmxalloc(long amount, int mode)
 
 ret:
     KDEBUG(("BDOS Mxalloc: returns 0x%08lx\n",(ULONG)ret_value));
+    KTRACE(KT_MXALLOC, amount, mode, ret_value, 0);
     dump_mem_map();
 
     return ret_value;
@@ -601,3 +713,64 @@ void set_owner(void *addr, PD *p)
         }
     }
 }
+
+#if OSMEM_MAX_BLOCKS
+/*
+ * take 'amount' bytes from the end of the highest free block of the
+ * pool that is large enough
+ *
+ * returns NULL if there is no such block
+ */
+static UBYTE *take_top(MPB *mpb, long amount)
+{
+    MD *p, *q, *m = NULL, *prev = NULL;
+    UBYTE *addr;
+
+    /* the free list is in ascending sequence */
+    for (p = (MD *)mpb, q = mpb->mp_mfl; q; p = q, q = q->m_link)
+    {
+        if (q->m_length >= amount)
+        {
+            m = q;
+            prev = p;
+        }
+    }
+    if (!m)
+        return NULL;
+
+    m->m_length -= amount;
+    addr = m->m_start + m->m_length;
+    if (m->m_length == 0)
+    {
+        prev->m_link = m->m_link;
+        xmfremd(m);
+    }
+
+    return addr;
+}
+
+/*
+ * allocate memory to grow the OS internal pool, preferably in alternate RAM
+ *
+ * like the blocks kept by Ptermres(), the memory is never freed.  it is
+ * taken from the top of free memory, so that it does not split the free
+ * memory below it when the current program terminates.
+ *
+ * returns NULL if there is not enough memory
+ */
+void *xmalloc_os(long amount)
+{
+    UBYTE *addr = NULL;
+
+    amount = (amount + 3) & ~3L;    /* keep the free blocks aligned */
+
+#if CONF_WITH_ALT_RAM
+    if (has_alt_ram)
+        addr = take_top(&pmdalt, amount);
+    if (!addr)
+#endif
+        addr = take_top(&pmd, amount);
+
+    return addr;
+}
+#endif
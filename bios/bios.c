@@ -62,6 +62,8 @@
 #include "amiga.h"
 #include "lisa.h"
 #include "coldfire.h"
+#include "bootprof.h"
+#include "ktrace.h"
 #if WITH_CLI
 #include "../cli/clistub.h"
 #endif
@@ -102,6 +104,10 @@ WORD boot_status;               /* see kprint.h for bit flags */
 /* Boot flags */
 UBYTE bootflags;
 
+#if CONF_WITH_IDLE_STATS
+IDLESTATS idlestats;
+#endif
+
 /* Non-Atari hardware vectors */
 #if !CONF_WITH_MFP
 void (*vector_5ms)(void);       /* 200 Hz system timer */
@@ -212,6 +218,13 @@ static void bios_init(void)
 {
     KDEBUG(("bios_init()\n"));
 
+#if CONF_WITH_BOOT_PROFILER
+    bootprof_init();
+#endif
+#if CONF_WITH_KTRACE
+    ktrace_init();
+#endif
+
     /* initialize Native Features, if available
      * do it as soon as possible so that kprintf can make use of them
      */
@@ -226,11 +239,13 @@ static void bios_init(void)
 #if CONF_WITH_UAE
     KDEBUG(("amiga_uae_init()\n"));
     amiga_uae_init();
+    BOOTPROF_MARK("uae_init");
 #endif
 
     /* Initialize the processor */
     KDEBUG(("processor_init()\n"));
     processor_init();   /* Set CPU type, longframe and FPU type */
+    BOOTPROF_MARK("cpu_init");
 
 #if CONF_WITH_ADVANCED_CPU
     is_bus32 = (UBYTE)detect_32bit_address_bus();
@@ -239,18 +254,23 @@ static void bios_init(void)
 
     KDEBUG(("vecs_init()\n"));
     vecs_init();        /* setup all exception vectors (above) */
+    BOOTPROF_MARK("vecs_init");
     KDEBUG(("init_delay()\n"));
     init_delay();       /* set 'reasonable' default values for delay */
+    BOOTPROF_MARK("init_delay");
 
     /* Detect optional hardware (video, sound, etc.) */
     KDEBUG(("machine_detect()\n"));
     machine_detect();   /* detect hardware */
+    BOOTPROF_MARK("mach_detect");
     KDEBUG(("machine_init()\n"));
     machine_init();     /* initialise machine-specific stuff */
+    BOOTPROF_MARK("mach_init");
 
     /* Initialize the BIOS memory management */
     KDEBUG(("bmem_init()\n"));
     bmem_init();
+    BOOTPROF_MARK("bmem_init");
 
 #if defined(MACHINE_AMIGA)
     /* Detect and initialize Zorro II/III expansion boards.
@@ -277,8 +297,10 @@ static void bios_init(void)
     cookie_init();      /* sets a cookie jar */
     KDEBUG(("fill_cookie_jar()\n"));
     fill_cookie_jar();  /* detect hardware features and fill the cookie jar */
+    BOOTPROF_MARK("cookie_jar");
     KDEBUG(("font_init()\n"));
     font_init();        /* initialize font ring (requires cookie_akp) */
+    BOOTPROF_MARK("font_init");
 
 #if CONF_WITH_BLITTER
     /*
@@ -300,6 +322,7 @@ static void bios_init(void)
 #if CONF_WITH_MFP
     KDEBUG(("mfp_init()\n"));
     mfp_init();
+    BOOTPROF_MARK("mfp_init");
 #endif
 
 #if CONF_WITH_TT_MFP
@@ -328,10 +351,12 @@ static void bios_init(void)
      */
     KDEBUG(("screen_init_mode()\n"));
     screen_init_mode(); /* detect monitor type, ... */
+    BOOTPROF_MARK("scr_init_mode");
 
     /* Set up the BIOS console output */
     KDEBUG(("linea_init()\n"));
     linea_init();       /* initialize screen related line-a variables */
+    BOOTPROF_MARK("linea_init");
 
     /*
      * Initialize the screen address
@@ -339,15 +364,18 @@ static void bios_init(void)
      */
     KDEBUG(("screen_init_address()\n"));
     screen_init_address();
+    BOOTPROF_MARK("scr_init_addr");
 
     KDEBUG(("vt52_init()\n"));
     vt52_init();        /* initialize the vt52 console */
+    BOOTPROF_MARK("vt52_init");
 
     /* Now kcprintf() will also send debug info to the screen */
     KDEBUG(("after vt52_init()\n"));
 
     /* now we have output, let the user know we're alive */
     display_startup_msg();
+    BOOTPROF_MARK("startup_msg");
 
 #if DETECT_NATIVE_FEATURES
     /*
@@ -385,6 +413,7 @@ static void bios_init(void)
      */
     KDEBUG(("init_system_timer()\n"));
     init_system_timer();
+    BOOTPROF_MARK("system_timer");
 
     /*
      * Now we can enable interrupts.  Although VBL & timer interrupts will
@@ -407,6 +436,7 @@ static void bios_init(void)
     boot_status |= CHARDEV_AVAILABLE;   /* track progress */
     KDEBUG(("init_serport()\n"));
     init_serport();
+    BOOTPROF_MARK("init_serport");
     boot_status |= RS232_AVAILABLE;     /* track progress */
 #if CONF_WITH_SCC
     if (has_scc)
@@ -426,6 +456,7 @@ static void bios_init(void)
 #endif
     KDEBUG(("snd_init()\n"));
     snd_init();         /* Reset Soundchip, deselect floppies */
+    BOOTPROF_MARK("snd_init");
 
     /*
      * Initialise the two ACIA devices (MIDI and KBD), then initialise
@@ -437,6 +468,7 @@ static void bios_init(void)
     midi_init();        /* init MIDI acia so that kbd acia irq works */
     KDEBUG(("init_acia_vecs()\n"));
     init_acia_vecs();   /* Init the ACIA interrupt vector and related stuff */
+    BOOTPROF_MARK("kbd_midi_init");
     KDEBUG(("after init_acia_vecs()\n"));
     boot_status |= MIDI_AVAILABLE;  /* track progress */
 
@@ -446,6 +478,7 @@ static void bios_init(void)
     KDEBUG(("calibrate_delay()\n"));
     calibrate_delay();  /* determine values for delay() function */
                         /*  - requires interrupts to be enabled  */
+    BOOTPROF_MARK("calib_delay");
 
     /* Initialize the DSP.  Since we currently use the system timer
      * in dsp_execboot(), which is called from dsp_init(), the latter
@@ -454,6 +487,7 @@ static void bios_init(void)
 #if CONF_WITH_DSP
     KDEBUG(("dsp_init()\n"));
     dsp_init();
+    BOOTPROF_MARK("dsp_init");
 #endif
 
 #if CONF_WITH_MEMORY_TEST
@@ -466,6 +500,7 @@ static void bios_init(void)
         cprintf("\n%s:\n",_("Memory test"));
         ok = memory_test();         /* simple memory test, like Atari TOS */
         cprintf("%s %s\n",_("Memory test"),ok?_("complete"):_("aborted"));
+        BOOTPROF_MARK("memory_test");
     }
 #endif
 
@@ -479,18 +514,22 @@ static void bios_init(void)
             stop_until_interrupt();
 #endif
         }
+        BOOTPROF_MARK("boot_delay");
     }
 
     KDEBUG(("blkdev_init()\n"));
     blkdev_init();      /* floppy and harddisk initialisation */
+    BOOTPROF_MARK("blkdev_init");
     KDEBUG(("after blkdev_init()\n"));
 
     /* initialize BIOS components */
 
     KDEBUG(("parport_init()\n"));
     parport_init();     /* parallel port */
+    BOOTPROF_MARK("parport_init");
     KDEBUG(("clock_init()\n"));
     clock_init();       /* init clock */
+    BOOTPROF_MARK("clock_init");
     KDEBUG(("after clock_init()\n"));
 
 #if CONF_WITH_NOVA
@@ -500,6 +539,7 @@ static void bios_init(void)
         if (init_nova()) {
             set_rez_hacked();   /* also reinitializes the vt52 console */
         }
+        BOOTPROF_MARK("init_nova");
     }
 #endif
 
@@ -507,6 +547,7 @@ static void bios_init(void)
     KDEBUG(("nls_init()\n"));
     nls_init();         /* init native language support */
     nls_set_lang(get_lang_name());
+    BOOTPROF_MARK("nls_init");
 #endif
 
     /* Set start of user interface.
@@ -516,16 +557,19 @@ static void bios_init(void)
 
     KDEBUG(("osinit_before_xmaddalt()\n"));
     osinit_before_xmaddalt();   /* initialize BDOS (part 1) */
+    BOOTPROF_MARK("osinit_1");
     KDEBUG(("after osinit_before_xmaddalt()\n"));
 
 #if CONF_WITH_ALT_RAM
     /* Add Alt-RAM to BDOS pool */
     KDEBUG(("altram_init()\n"));
     altram_init();
+    BOOTPROF_MARK("altram_init");
 #endif
 
     KDEBUG(("osinit_after_xmaddalt()\n"));
     osinit_after_xmaddalt();    /* initialize BDOS (part 2) */
+    BOOTPROF_MARK("osinit_2");
     KDEBUG(("after osinit_after_xmaddalt()\n"));
     boot_status |= DOS_AVAILABLE;   /* track progress */
 
@@ -544,6 +588,7 @@ static void bios_init(void)
          */
         KDEBUG(("run_cartridge_applications(3)\n"));
         run_cartridge_applications(3); /* Type "Execute prior to bootdisk" */
+        BOOTPROF_MARK("cartridge");
         KDEBUG(("after run_cartridge_applications()\n"));
 
         if ((V_REZ_HZ != save_hz) || (V_REZ_VT != save_vt) || (v_planes != save_pl))
@@ -669,6 +714,7 @@ static void run_auto_program(const char* filename)
     KDEBUG(("Loading %s ...\n", path));
     Pexec(PE_LOADGO, path, "", NULL);
     KDEBUG(("[OK]\n"));
+    BOOTPROF_MARK(filename);
 }
 
 static void autoexec(void)
@@ -766,6 +812,7 @@ void biosmain(void)
      * This may change drvbits. See Steem sources:
      * File steem/code/emulator.cpp, function intercept_bios(). */
     Drvmap();
+    BOOTPROF_MARK("drvmap");
 
     /*
      * if it's not the first boot, we use the existing bootdev.
@@ -787,6 +834,7 @@ void biosmain(void)
         bootdev = initinfo(&shiftbits); /* show the welcome screen */
     else
         shiftbits = kbshift(-1);
+    BOOTPROF_MARK("initinfo");
 
     KDEBUG(("bootdev = %d\n", bootdev));
 
@@ -800,6 +848,7 @@ void biosmain(void)
 
     /* boot eventually from a block device (floppy or harddisk) */
     blkdev_boot();
+    BOOTPROF_MARK("blkdev_boot");
 
     Dsetdrv(bootdev);           /* Set boot drive */
     init_default_environment(); /* Build default environment string */
@@ -822,6 +871,10 @@ void biosmain(void)
 
     autoexec();                 /* autoexec PRGs from AUTO folder */
 
+#if CONF_WITH_BOOT_PROFILER
+    bootprof_report();          /* all done, show where the time went */
+#endif
+
     /* clear commandline */
 
     if(cmdload != 0) {
@@ -961,6 +1014,31 @@ static LONG bios_2(WORD handle)
 }
 #endif
 
+/*
+ * idle_wait - wait for an interrupt
+ *
+ * This is called repeatedly by loops waiting for something that will be
+ * signalled by an interrupt, such as console input or AES events.  If
+ * enabled, the CPU is stopped until the next interrupt; the time spent
+ * here is accumulated in idlestats.  Note that the timer interrupt always
+ * ends the wait, so the caller will not wait for longer than 5 ms.
+ */
+void idle_wait(void)
+{
+#if CONF_WITH_IDLE_STATS
+    ULONG start = hz_200;
+#endif
+
+#if USE_STOP_INSN_WHEN_IDLE
+    stop_until_interrupt();
+#endif
+
+#if CONF_WITH_IDLE_STATS
+    idlestats.idle_ticks += hz_200 - start;
+    idlestats.idle_waits++;
+#endif
+}
+
 /**
  * bconout  - Print character to output device
  */
@@ -987,6 +1065,41 @@ LONG bconout(WORD handle, WORD what)
     return 0L;
 }
 
+#if CONF_WITH_BLOCK_CONOUT
+/*
+ * bconws - output a run of printable characters to the console
+ *
+ * This is called directly by the BDOS, not via trap.  The run is output
+ * in one go by the VT52 emulator (and copied to the serial port if it
+ * is the console).  If the handle is not the console, or the BIOS trap
+ * or the console Bconout() vector has been hooked, nothing is output and
+ * -1 is returned: the caller must then output each character via
+ * Bconout(), so that the hook sees them all.  A count of 0 may be used
+ * to check this before scanning for a run.
+ *
+ * returns the number of characters output, or -1
+ */
+LONG bconws(WORD handle, const char *buf, LONG count)
+{
+    LONG n;
+    WORD len;
+
+    if ((handle != 2) || !(boot_status & CHARDEV_AVAILABLE))
+        return -1L;
+
+    if ((VEC_BIOS != biostrap) || (bconout_vec[2] != bconout2))
+        return -1L;
+
+    for (n = count; n > 0; n -= len, buf += len)
+    {
+        len = (n > 0x7fff) ? 0x7fff : (WORD)n;
+        cputs_block((const UBYTE *)buf, len);
+    }
+
+    return count;
+}
+#endif
+
 #if DBGBIOS
 static LONG bios_3(WORD handle, WORD what)
 {
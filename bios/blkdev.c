@@ -34,6 +34,7 @@
 #include "biosmem.h"
 #include "xhdi.h"
 #include "intmath.h"
+#include "ktrace.h"
 
 
 /*
@@ -49,6 +50,10 @@
 
 BLKDEV blkdev[BLKDEVNUM];
 
+#if CONF_WITH_IO_STATS
+IOSTATS iostats;
+#endif
+
 static PUN_INFO pun_info;
 
 /*
@@ -419,6 +424,7 @@ static LONG blkdev_rwabs(WORD rw, UBYTE *buf, WORD cnt, WORD recnr, WORD dev, LO
 
     KDEBUG(("rwabs(rw=%d, buf=%p, count=%ld, recnr=%u, dev=%d, lrecnr=%ld)\n",
             rw,buf,lcount,recnr,dev,lrecnr));
+    KTRACE(KT_RWABS, rw, dev, (recnr != -1) ? (UWORD)recnr : lrecnr, cnt);
 
     /*
      * handle special undocumented feature in the floppy-only Rwabs() handler
@@ -526,6 +532,12 @@ static LONG blkdev_rwabs(WORD rw, UBYTE *buf, WORD cnt, WORD recnr, WORD dev, LO
         } while(retval == CRITIC_RETRY_REQUEST);
         if (retval < 0)     /* error, retries exhausted */
             break;
+#if CONF_WITH_IO_STATS
+        if ((rw&RW_RW) == RW_READ)
+            iostats.sectors_read += scount;
+        else
+            iostats.sectors_written += scount;
+#endif
         buf += (ULONG)scount << psshift;
         lrecnr += scount;
         lcount -= scount;
@@ -542,6 +554,8 @@ static LONG blkdev_rwabs(WORD rw, UBYTE *buf, WORD cnt, WORD recnr, WORD dev, LO
         if (unit >= NUMFLOPPIES)
             disk_rescan(unit);
 
+    KTRACE(KT_RWABS_DONE, retval, 0, 0, 0);
+
     return retval;
 }
 
@@ -0,0 +1,94 @@
+/*
+ * bootprof.c - boot phase profiler
+ *
+ * Records the value of hz_200 at the end of each stage of bios_init()
+ * and biosmain(), and after each AUTO program.  The resulting table is
+ * kept in memory (see the cookie COOKIE_BOOTPROF) so that it can be
+ * fetched later by a tool, and is also sent to the debug console,
+ * sorted by decreasing duration, just before the shell is started.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "emutos.h"
+#include "biosdefs.h"
+#include "tosvars.h"
+#include "string.h"
+#include "bootprof.h"
+
+#if CONF_WITH_BOOT_PROFILER
+
+BOOTPROF bootprof;
+
+/*
+ * start a new profile
+ */
+void bootprof_init(void)
+{
+    bzero(&bootprof, sizeof(bootprof));
+    bootprof.version = BOOTPROF_VERSION;
+    bootprof.max = BOOTPROF_MAX_ENTRIES;
+    bootprof.hz = CLOCKS_PER_SEC;
+    bootprof.start = hz_200;
+}
+
+/*
+ * record the end of the boot stage 'name'
+ *
+ * entries beyond the end of the table are silently dropped
+ */
+void bootprof_mark(const char *name)
+{
+    BOOTPROF_ENTRY *e;
+
+    if (bootprof.count >= BOOTPROF_MAX_ENTRIES)
+        return;
+
+    e = &bootprof.entry[bootprof.count++];
+    e->ticks = hz_200;
+    strlcpy(e->name, name, BOOTPROF_NAMELEN);
+}
+
+/*
+ * return the duration of entry n, in ticks
+ */
+static ULONG stage_duration(WORD n)
+{
+    ULONG prev = n ? bootprof.entry[n-1].ticks : bootprof.start;
+
+    return bootprof.entry[n].ticks - prev;
+}
+
+/*
+ * send the profile to the debug console, longest stages first
+ */
+void bootprof_report(void)
+{
+    WORD order[BOOTPROF_MAX_ENTRIES];
+    WORD i, j, n = bootprof.count;
+    ULONG total;
+
+    /* insertion sort: the table is small, and only sorted once */
+    for (i = 0; i < n; i++)
+    {
+        for (j = i; (j > 0) && (stage_duration(order[j-1]) < stage_duration(i)); j--)
+            order[j] = order[j-1];
+        order[j] = i;
+    }
+
+    total = n ? bootprof.entry[n-1].ticks - bootprof.start : 0UL;
+
+    KINFO(("Boot profile: %d stages, %lu ms total\n", n, total * 1000UL / CLOCKS_PER_SEC));
+    for (i = 0; i < n; i++)
+    {
+        j = order[i];
+        KINFO(("  %-14s %6lu ms  (at %lu ms)\n", bootprof.entry[j].name,
+                stage_duration(j) * 1000UL / CLOCKS_PER_SEC,
+                (bootprof.entry[j].ticks - bootprof.start) * 1000UL / CLOCKS_PER_SEC));
+    }
+}
+
+#endif /* CONF_WITH_BOOT_PROFILER */
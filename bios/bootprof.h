@@ -0,0 +1,56 @@
+/*
+ * bootprof.h - header for the boot phase profiler
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef _BOOTPROF_H
+#define _BOOTPROF_H
+
+#if CONF_WITH_BOOT_PROFILER
+
+#define BOOTPROF_VERSION    1
+#define BOOTPROF_NAMELEN    14      /* enough for an 8.3 AUTO program name */
+
+/*
+ * one entry per completed boot stage
+ *
+ * 'ticks' is the value of hz_200 when the stage ended; the duration of
+ * a stage is the difference with the previous entry.  Note that hz_200
+ * does not advance before init_system_timer() has been called.
+ */
+typedef struct {
+    ULONG ticks;
+    char name[BOOTPROF_NAMELEN];
+} BOOTPROF_ENTRY;
+
+/*
+ * the in-memory profile, pointed to by the cookie COOKIE_BOOTPROF
+ */
+typedef struct {
+    UWORD version;              /* BOOTPROF_VERSION */
+    UWORD count;                /* number of valid entries */
+    UWORD max;                  /* size of entry[] */
+    UWORD hz;                   /* timer frequency of 'ticks' */
+    ULONG start;                /* hz_200 when profiling started */
+    BOOTPROF_ENTRY entry[BOOTPROF_MAX_ENTRIES];
+} BOOTPROF;
+
+extern BOOTPROF bootprof;
+
+void bootprof_init(void);
+void bootprof_mark(const char *name);
+void bootprof_report(void);
+
+#define BOOTPROF_MARK(name) bootprof_mark(name)
+
+#else
+
+#define BOOTPROF_MARK(name) NULL_FUNCTION()
+
+#endif /* CONF_WITH_BOOT_PROFILER */
+
+#endif /* _BOOTPROF_H */
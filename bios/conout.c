@@ -23,6 +23,7 @@
 #include "sound.h"              /* for bell() */
 #include "string.h"
 #include "conout.h"
+#include "screen.h"
 
 
 
@@ -117,6 +118,154 @@ static UBYTE *cell_addr(UWORD x, UWORD y)
 
 
 
+#if CONF_WITH_GLYPH_CACHE
+
+/*
+ * glyph cache for 2, 4 & 8 plane modes
+ *
+ * In multi-plane modes, cell_xfer() must work out for every plane of
+ * every character whether to store zeros, ones, the font data or the
+ * inverted font data.  To avoid this, recently-used characters are kept
+ * pre-expanded into interleaved plane bytes for the current colours and
+ * font, so that outputting a character is a simple copy.
+ *
+ * The cache is direct-mapped by glyph offset within the font.  Since the
+ * colours & font may be changed directly via the line-A variables, the
+ * values that the cache depends on are checked on every call, and the
+ * cache is flushed if any of them has changed.
+ */
+#define GLYPH_CACHE_ENTRIES 128     /* maximum, must be a power of 2 */
+
+static struct {
+    const UWORD *font;              /* v_fnt_ad */
+    UWORD fg, bg;                   /* after allowing for reverse video */
+    UWORD planes, height, fnt_wr;
+    UWORD mask;                     /* number of entries - 1 */
+    UWORD size;                     /* bytes per entry */
+    UBYTE fgmask[8], bgmask[8];     /* per plane: 0x00 or 0xff */
+                                    /* (so at most 8 planes) */
+    UWORD tag[GLYPH_CACHE_ENTRIES]; /* glyph offset + 1, 0 => empty */
+} gcache;
+
+static UBYTE glyph_data[GLYPH_CACHE_SIZE];
+
+
+
+/*
+ * glyph_flush - set up an empty glyph cache for the current colours & font
+ */
+
+static void glyph_flush(UWORD fg, UWORD bg)
+{
+    UWORD n;
+    int plane;
+
+    gcache.font = v_fnt_ad;
+    gcache.fg = fg;
+    gcache.bg = bg;
+    gcache.planes = v_planes;
+    gcache.height = v_cel_ht;
+    gcache.fnt_wr = v_fnt_wr;
+    gcache.size = v_planes * v_cel_ht;
+
+    /* as many entries as will fit, rounded down to a power of 2 */
+    for (n = GLYPH_CACHE_ENTRIES; n > GLYPH_CACHE_SIZE / gcache.size; n >>= 1)
+        ;
+    gcache.mask = n - 1;            /* n = 0 => cache unusable */
+
+    for (plane = 0; plane < v_planes; plane++, fg >>= 1, bg >>= 1) {
+        gcache.fgmask[plane] = (fg & 0x0001) ? 0xff : 0x00;
+        gcache.bgmask[plane] = (bg & 0x0001) ? 0xff : 0x00;
+    }
+
+    bzero(gcache.tag, sizeof(gcache.tag));
+}
+
+
+
+/*
+ * glyph_lookup - get the expanded version of a glyph
+ *
+ * in:
+ *   src - points to the glyph in the font
+ *   fg, bg - the colours to use
+ *
+ * out:
+ *   pointer to the expanded glyph, or NULL if the cache cannot be used
+ */
+
+static const UBYTE *glyph_lookup(const UBYTE *src, UWORD fg, UWORD bg)
+{
+    UBYTE *g;
+    UWORD offs, index;
+    int i, plane;
+
+    if ((v_fnt_ad != gcache.font) || (fg != gcache.fg) || (bg != gcache.bg)
+     || (v_planes != gcache.planes) || (v_cel_ht != gcache.height)
+     || (v_fnt_wr != gcache.fnt_wr))
+        glyph_flush(fg, bg);
+
+    if (gcache.mask == (UWORD)-1)   /* no entries */
+        return NULL;
+
+    offs = src - (const UBYTE *)gcache.font;
+    index = offs & gcache.mask;
+    g = glyph_data + index * gcache.size;
+
+    if (gcache.tag[index] == offs + 1)
+        return g;
+
+    /* expand the glyph into the cache */
+    for (i = v_cel_ht; i--; src += v_fnt_wr) {
+        UBYTE s = *src;
+        for (plane = 0; plane < v_planes; plane++)
+            *g++ = (s & gcache.fgmask[plane]) | (~s & gcache.bgmask[plane]);
+    }
+    gcache.tag[index] = offs + 1;
+
+    return glyph_data + index * gcache.size;
+}
+
+
+
+/*
+ * glyph_xfer - copy an expanded glyph to the screen
+ */
+
+static void glyph_xfer(const UBYTE *g, UBYTE *dst)
+{
+    int i, plane;
+    UWORD line_wr = v_lin_wr;
+
+    switch(v_planes) {
+    case 2:
+        for (i = v_cel_ht; i--; dst += line_wr) {
+            dst[0] = *g++;
+            dst[2] = *g++;
+        }
+        break;
+    case 4:
+        for (i = v_cel_ht; i--; dst += line_wr) {
+            dst[0] = *g++;
+            dst[2] = *g++;
+            dst[4] = *g++;
+            dst[6] = *g++;
+        }
+        break;
+    case 8:
+        for (i = v_cel_ht; i--; dst += line_wr) {
+            UBYTE *d = dst;
+            for (plane = 8; plane--; d += PLANE_OFFSET)
+                *d = *g++;
+        }
+        break;
+    }
+}
+
+#endif /* CONF_WITH_GLYPH_CACHE */
+
+
+
 /*
  * cell_xfer - Performs a byte aligned block transfer.
  *
@@ -155,6 +304,17 @@ static void cell_xfer(UBYTE *src, UBYTE *dst)
         bg = v_col_bg;
     }
 
+#if CONF_WITH_GLYPH_CACHE
+    /* the cache only handles the 2, 4 & 8 plane modes, see gcache */
+    if ((v_planes == 2) || (v_planes == 4) || (v_planes == 8)) {
+        const UBYTE *g = glyph_lookup(src, fg, bg);
+        if (g) {
+            glyph_xfer(g, dst);
+            return;
+        }
+    }
+#endif
+
     src_sav = src;
     dst_sav = dst;
 
@@ -379,31 +539,14 @@ void move_cursor(int x, int y)
 
 
 /*
- * ascii_out - prints an ascii character on the screen
- *
- * in:
+ * put_cell - output a character cell at the cursor and advance the cursor
  *
- * ch.w      ascii code for character
+ * the caller must have hidden the cursor
  */
-
-void ascii_out(int ch)
+static void put_cell(UBYTE *src)
 {
-    UBYTE * src, * dst;
-    BOOL visible;                       /* was the cursor visible? */
-
-    src = char_addr(ch);                /* a0 -> get character source */
-    if (src == NULL)
-        return;                         /* no valid character */
-
-    dst = v_cur_ad;                     /* a1 -> get destination */
-
-    visible = v_stat_0 & M_CVIS;        /* test visibility bit */
-    if (visible) {
-        v_stat_0 &= ~M_CVIS;                    /* start of critical section */
-    }
-
     /* put the cell out (this covers the cursor) */
-    cell_xfer(src, dst);
+    cell_xfer(src, v_cur_ad);
 
     /* advance the cursor and update cursor address and coordinates */
     if (next_cell()) {
@@ -421,10 +564,20 @@ void ascii_out(int ch)
         }
         else {
             scroll_up(0);               /* scroll from top of screen */
+            /* the screen base may have moved */
+            cell = v_bas_ad + (ULONG)v_cel_wr * y;
         }
         v_cur_ad = cell;                /* update cursor address */
     }
+}
+
+
 
+/*
+ * show_cursor_again - redisplay the cursor after output, if it was visible
+ */
+static void show_cursor_again(BOOL visible)
+{
     /* if visible */
     if (visible) {
         neg_cell(v_cur_ad);             /* display cursor. */
@@ -440,6 +593,64 @@ void ascii_out(int ch)
 
 
 
+/*
+ * ascii_out - prints an ascii character on the screen
+ *
+ * in:
+ *
+ * ch.w      ascii code for character
+ */
+
+void ascii_out(int ch)
+{
+    UBYTE * src;
+    BOOL visible;                       /* was the cursor visible? */
+
+    src = char_addr(ch);                /* a0 -> get character source */
+    if (src == NULL)
+        return;                         /* no valid character */
+
+    visible = v_stat_0 & M_CVIS;        /* test visibility bit */
+    if (visible) {
+        v_stat_0 &= ~M_CVIS;                    /* start of critical section */
+    }
+
+    put_cell(src);
+    show_cursor_again(visible);
+}
+
+
+
+#if CONF_WITH_BLOCK_CONOUT
+/*
+ * ascii_out_block - prints a run of ascii characters on the screen
+ *
+ * This is equivalent to calling ascii_out() for each character, but
+ * the cursor is only hidden and redisplayed once for the whole run.
+ */
+
+void ascii_out_block(const UBYTE *buf, WORD count)
+{
+    UBYTE * src;
+    BOOL visible;                       /* was the cursor visible? */
+
+    visible = v_stat_0 & M_CVIS;        /* test visibility bit */
+    if (visible) {
+        v_stat_0 &= ~M_CVIS;                    /* start of critical section */
+    }
+
+    while (count-- > 0) {
+        src = char_addr(*buf++);
+        if (src)
+            put_cell(src);
+    }
+
+    show_cursor_again(visible);
+}
+#endif
+
+
+
 /*
  * blank_out - Fills region with the background color.
  *
@@ -537,6 +748,72 @@ void blank_out(int topx, int topy, int botx, int boty)
 
 
 
+#if CONF_WITH_VIRTUAL_SCROLL
+
+/*
+ * vscroll - scroll the whole screen by moving the screen base
+ *
+ * The screen memory is used as a ring: the screen base moves by one cell
+ * row, and only the newly-exposed row needs to be blanked.  When the
+ * base would move outside the screen memory, the rows that remain
+ * visible are first copied to the other end, so the cost of copying the
+ * screen is shared between many scrolls.
+ *
+ * in:
+ *   dir - 1 to scroll up, -1 to scroll down
+ *
+ * out:
+ *   FALSE if this is not possible, in which case the caller must copy
+ *   the screen contents as usual
+ */
+
+static BOOL vscroll(int dir)
+{
+    UBYTE *start, *end, *base;
+    ULONG size;
+
+    /* the cell rows must cover the whole screen */
+    size = (ULONG)v_cel_wr * (v_cel_my + 1);
+    if ((size != (ULONG)v_lin_wr * V_REZ_VT) || v_cur_of)
+        return FALSE;
+
+    if (!vscroll_get_area(v_cel_wr, &start, &end))
+        return FALSE;
+
+    if (start + size + v_cel_wr > end)  /* not enough memory (rez change?) */
+        return FALSE;
+
+    if (dir > 0) {
+        base = v_bas_ad + v_cel_wr;
+        if (base + size > end) {
+            memmove(start, base, size - v_cel_wr);
+            base = start;
+        }
+    } else {
+        base = v_bas_ad - v_cel_wr;
+        if (base < start) {
+            /* highest row-aligned base within the screen memory */
+            base = start + (end - start - size) / v_cel_wr * v_cel_wr;
+            memmove(base + v_cel_wr, v_bas_ad, size - v_cel_wr);
+        }
+    }
+
+    /* keep the cursor on the same row of the screen */
+    v_cur_ad = base + (v_cur_ad - v_bas_ad);
+    vscroll_set_base(base);
+
+    if (dir > 0)
+        blank_out(0, v_cel_my, v_cel_mx, v_cel_my);
+    else
+        blank_out(0, 0, v_cel_mx, 0);
+
+    return TRUE;
+}
+
+#endif /* CONF_WITH_VIRTUAL_SCROLL */
+
+
+
 /*
  * scroll_up - Scroll upwards
  *
@@ -560,6 +837,11 @@ void scroll_up(UWORD top_line)
     ULONG count;
     UBYTE * src, * dst;
 
+#if CONF_WITH_VIRTUAL_SCROLL
+    if ((top_line == 0) && vscroll(1))
+        return;
+#endif
+
     /* screen base addr + cell y nbr * cell wrap */
     dst = v_bas_ad + (ULONG)top_line * v_cel_wr;
 
@@ -587,6 +869,11 @@ void scroll_down(UWORD start_line)
     ULONG count;
     UBYTE * src, * dst;
 
+#if CONF_WITH_VIRTUAL_SCROLL
+    if ((start_line == 0) && vscroll(-1))
+        return;
+#endif
+
     /* screen base addr + offset of start line */
     src = v_bas_ad + (ULONG)start_line * v_cel_wr;
 
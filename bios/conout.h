@@ -49,6 +49,9 @@ extern WORD sav_cur_y;          /* saved cursor cell y */
 /* Prototypes */
 
 void ascii_out(int);
+#if CONF_WITH_BLOCK_CONOUT
+void ascii_out_block(const UBYTE *buf, WORD count);
+#endif
 void move_cursor(int, int);
 void blank_out (int, int, int, int);
 void invert_cell(int, int);
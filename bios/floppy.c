@@ -51,6 +51,7 @@
  * - xbios floprd, flopwr, flopver
  * - xbios flopfmt
  * - internal flopio, fropwtrack
+ * - internal track cache
  * - internal status, flopvbl
  * - low level dma and fdc registers access
  *
@@ -115,6 +116,8 @@ static WORD flopio(UBYTE *buf, WORD rw, WORD dev,
                    WORD sect, WORD track, WORD side, WORD count);
 static WORD flopio_ver(UBYTE *buf, WORD rw, WORD dev,
                    WORD sect, WORD track, WORD side, WORD count);
+static WORD flopio_trkside(UBYTE *buf, WORD rw, WORD dev, WORD sect,
+                   WORD track, WORD side, WORD count, WORD spt);
 
 /* floppy write track */
 static WORD flopwtrack(UBYTE *buf, WORD dev, WORD track, WORD side,
@@ -123,6 +126,14 @@ static WORD flopwtrack(UBYTE *buf, WORD dev, WORD track, WORD side,
 /* initialise a floppy for hdv_init */
 static void flop_detect_drive(WORD dev);
 
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+/* whole-track read cache */
+static void tcache_init(void);
+static void tcache_invalidate(WORD dev);
+static WORD tcache_read(UBYTE *buf, WORD dev, WORD sect, WORD track,
+                        WORD side, WORD count, WORD spt);
+#endif
+
 #if CONF_WITH_FDC
 
 /* called at start and end of a floppy access. */
@@ -343,6 +354,10 @@ void flop_hdv_init(void)
         flopunlk();
     }
 #endif
+
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+    tcache_init();
+#endif
 }
 
 /*
@@ -487,6 +502,9 @@ LONG flop_mediach(WORD dev)
      * change.  we clear the latch & will report a change of some kind.
      */
     fi->wplatch = FALSE;
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+    tcache_invalidate(dev);
+#endif
 
     /*
      * if the current status is clear, then we must have gone from a WP
@@ -596,7 +614,7 @@ LONG floppy_rw(WORD rw, UBYTE *buf, WORD cnt, LONG recnr, WORD spt,
         numsecs = spt - start_relsec;
         KDEBUG(("floppy_rw() #1: track=%d, side=%d, start=%d, count=%d\n",
                 track,side,start_relsec+1,numsecs));
-        err = flopio_ver(buf, rw, dev, start_relsec+1, track, side, numsecs);
+        err = flopio_trkside(buf, rw, dev, start_relsec+1, track, side, numsecs, spt);
         if (err)
             return err;
         buf += SECTOR_SIZE * numsecs;
@@ -617,7 +635,7 @@ LONG floppy_rw(WORD rw, UBYTE *buf, WORD cnt, LONG recnr, WORD spt,
         }
         KDEBUG(("floppy_rw() #2: track=%d, side=%d, start=%d, count=%d\n",
                 track,side,1,spt));
-        err = flopio_ver(buf, rw, dev, 1, track, side, spt);
+        err = flopio_trkside(buf, rw, dev, 1, track, side, spt, spt);
         if (err)
             return err;
         buf += SECTOR_SIZE * spt;
@@ -636,7 +654,7 @@ LONG floppy_rw(WORD rw, UBYTE *buf, WORD cnt, LONG recnr, WORD spt,
     numsecs = end_relsec - start_relsec + 1;
     KDEBUG(("floppy_rw() #3: track=%d, side=%d, start=%d, count=%d\n",
             track,side,start_relsec+1,numsecs));
-    err = flopio_ver(buf, rw, dev, start_relsec+1, track, side, numsecs);
+    err = flopio_trkside(buf, rw, dev, start_relsec+1, track, side, numsecs, spt);
     if (err)
         return err;
 
@@ -925,6 +943,10 @@ LONG flopfmt(UBYTE *buf, WORD *skew, WORD dev, WORD spt,
     if (magic != 0x87654321UL)
         return EBADSF;          /* just like TOS4 */
 
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+    tcache_invalidate(dev);
+#endif
+
     if ((spt >= 13) && (spt <= 20)) {
         density = DENSITY_HD;
         track_size = TRACK_SIZE_HD;
@@ -1098,6 +1120,11 @@ static WORD flopio(UBYTE *userbuf, WORD rw, WORD dev,
         /* TODO, maybe media changed ? */
     }
 
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+    if (rw == RW_WRITE)
+        tcache_invalidate(dev);
+#endif
+
 #ifdef MACHINE_AMIGA
     err = amiga_floprw(userbuf, rw, dev, sect, track, side, count);
     units[dev].last_access = hz_200;
@@ -1224,6 +1251,21 @@ static WORD flopio_ver(UBYTE *buf, WORD rw, WORD dev, WORD sect, WORD track, WOR
     return err;
 }
 
+/*
+ * performs flopio_ver() for sectors within a single track/side, using the
+ * track cache for reads if possible
+ */
+static WORD flopio_trkside(UBYTE *buf, WORD rw, WORD dev, WORD sect, WORD track, WORD side, WORD count, WORD spt)
+{
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+    /* reads of an entire track/side go directly to the user buffer */
+    if (((rw & RW_RW) == RW_READ) && (count < spt))
+        return tcache_read(buf, dev, sect, track, side, count, spt);
+#endif
+
+    return flopio_ver(buf, rw, dev, sect, track, side, count);
+}
+
 /*==== internal flopwtrack =================================================*/
 
 static WORD flopwtrack(UBYTE *userbuf, WORD dev, WORD track, WORD side, WORD track_size, WORD density)
@@ -1266,6 +1308,113 @@ static WORD flopwtrack(UBYTE *userbuf, WORD dev, WORD track, WORD side, WORD tra
 #endif
 }
 
+/*==== internal track cache ===============================================*/
+
+#if CONF_WITH_FLOPPY_TRACK_CACHE
+
+/*
+ * the BDOS reads files a few sectors at a time, so when reading sectors
+ * one request at a time, the next sector has usually passed the head by
+ * the time it is requested, costing one disk revolution per request.
+ * to avoid this, the first read from a track/side reads the entire
+ * track/side into a cache buffer in ST-RAM; subsequent reads are then
+ * satisfied from the buffer.
+ *
+ * there is one cache entry per side, so that both sides of the current
+ * cylinder are cached.  an entry is discarded when:
+ *  . any sector is written on the same drive, by flopio() or flopfmt()
+ *  . a possible media change is detected by flop_mediach()
+ *  . it has not been used for TCACHE_TIMEOUT ticks, as a precaution
+ *    against undetected media changes
+ */
+#define TCACHE_MAXSPT   18      /* enough for HD diskettes */
+#define TCACHE_TIMEOUT  (2*CLOCKS_PER_SEC)
+
+struct tcache_entry {
+    UBYTE *buf;         /* NULL => track cache not available */
+    WORD dev;           /* -1 => entry is empty */
+    WORD track;
+    WORD spt;
+    ULONG last_used;
+};
+
+static struct tcache_entry tcache[2];   /* indexed by side */
+
+static BOOL tcache_done;    /* TRUE after the first call of tcache_init() */
+
+/*
+ * since flop_hdv_init() is also the public hdv_init vector, this may be
+ * called after the BDOS has taken over the memory: the buffers are only
+ * allocated by the first call, during boot.  later calls just empty the
+ * cache.
+ */
+static void tcache_init(void)
+{
+    struct tcache_entry *e;
+    UBYTE *p = NULL;
+
+    if (tcache_done) {
+        for (e = tcache; e < tcache + ARRAY_SIZE(tcache); e++)
+            e->dev = -1;
+        return;
+    }
+    tcache_done = TRUE;
+
+    /* don't use any memory if we have no floppy drives */
+    if (nflops)
+        p = balloc_stram(ARRAY_SIZE(tcache) * TCACHE_MAXSPT * SECTOR_SIZE, FALSE);
+
+    for (e = tcache; e < tcache + ARRAY_SIZE(tcache); e++) {
+        e->buf = p;
+        e->dev = -1;
+        if (p)
+            p += TCACHE_MAXSPT * SECTOR_SIZE;
+    }
+}
+
+static void tcache_invalidate(WORD dev)
+{
+    struct tcache_entry *e;
+
+    for (e = tcache; e < tcache + ARRAY_SIZE(tcache); e++)
+        if (e->dev == dev)
+            e->dev = -1;
+}
+
+static WORD tcache_read(UBYTE *buf, WORD dev, WORD sect, WORD track,
+                        WORD side, WORD count, WORD spt)
+{
+    struct tcache_entry *e = &tcache[side&1];
+    WORD err;
+
+    if (!e->buf || (spt > TCACHE_MAXSPT))
+        return flopio(buf, RW_READ, dev, sect, track, side, count);
+
+    if ((e->dev != dev) || (e->track != track) || (e->spt != spt)
+     || (hz_200 - e->last_used > TCACHE_TIMEOUT)) {
+        e->dev = -1;
+        err = flopio(e->buf, RW_READ, dev, 1, track, side, spt);
+        if (err) {
+            /*
+             * the error may be in a sector that we don't need, so
+             * retry with just the sectors that were requested
+             */
+            KDEBUG(("tcache_read(): can't read track %d/%d, err=%d\n",track,side,err));
+            return flopio(buf, RW_READ, dev, sect, track, side, count);
+        }
+        e->dev = dev;
+        e->track = track;
+        e->spt = spt;
+    }
+
+    e->last_used = hz_200;
+    memcpy(buf, e->buf + (sect-1) * SECTOR_SIZE, count * SECTOR_SIZE);
+
+    return 0;
+}
+
+#endif /* CONF_WITH_FLOPPY_TRACK_CACHE */
+
 #if CONF_WITH_FDC
 
 /*==== internal status, flopvbl ===========================================*/
@@ -259,11 +259,8 @@ LONG bconin2(void)
     /* Check the IKBD IOREC */
     WORD old_sr;
 
-    while (!bconstat2()) {
-#if USE_STOP_INSN_TO_FREE_HOST_CPU
-        stop_until_interrupt();
-#endif
-    }
+    while (!bconstat2())
+        idle_wait();
     /* disable interrupts */
     old_sr = set_sr(0x2700);
 
@@ -0,0 +1,92 @@
+/*
+ * ktrace.c - kernel event trace
+ *
+ * Records fixed-size binary events (timestamp, event id, 4 arguments)
+ * from hot paths of the BIOS and BDOS into a ring buffer in RAM.  This
+ * is much cheaper than formatting text with KDEBUG() and sending it to
+ * the debug console, so it hardly changes the timing being examined.
+ * The buffer is found via the cookie COOKIE_KTRACE, and can be decoded
+ * later, e.g. by the EmuCON2 'trace' command.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "emutos.h"
+#include "biosdefs.h"
+#include "tosvars.h"
+#include "asm.h"
+#include "string.h"
+#include "ktrace.h"
+
+#if CONF_WITH_KTRACE
+
+KTRACE ktrace;
+
+/*
+ * start recording
+ */
+void ktrace_init(void)
+{
+    bzero(&ktrace, sizeof(ktrace));
+    ktrace.version = KTRACE_VERSION;
+    ktrace.max = KTRACE_EVENTS;
+    ktrace.hz = CLOCKS_PER_SEC;
+    ktrace.enabled = 1;
+}
+
+/*
+ * record one event
+ *
+ * this may be called from interrupt handlers, so interrupts are masked
+ * while the slot is filled
+ */
+void ktrace_event(UWORD id, ULONG a0, ULONG a1, ULONG a2, ULONG a3)
+{
+    KTRACE_EVENT *e;
+    WORD old_sr;
+
+    if (!ktrace.enabled)
+        return;
+
+    old_sr = set_sr(0x2700);
+
+    e = &ktrace.event[ktrace.count % KTRACE_EVENTS];
+    e->ticks = hz_200;
+    e->id = id;
+    e->seq = (UWORD)ktrace.count++;
+    e->arg[0] = a0;
+    e->arg[1] = a1;
+    e->arg[2] = a2;
+    e->arg[3] = a3;
+
+    set_sr(old_sr);
+}
+
+/*
+ * record an event whose arguments 1 & 2 hold the first 8 characters
+ * of the filename part of 'path', NUL-padded
+ */
+void ktrace_file(UWORD id, ULONG a0, const char *path, ULONG a3)
+{
+    const char *p;
+    ULONG name[2];
+    char *s = (char *)name;
+    WORD i;
+
+    if (!ktrace.enabled)
+        return;
+
+    for (p = path; *path; path++)
+        if ((*path == '\\') || (*path == ':'))
+            p = path + 1;
+
+    for (i = 0; i < (WORD)sizeof(name); i++)
+        s[i] = *p ? *p++ : '\0';
+
+    ktrace_event(id, a0, name[0], name[1], a3);
+}
+
+#endif /* CONF_WITH_KTRACE */
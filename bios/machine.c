@@ -43,6 +43,8 @@
 #include "nova.h"
 #include "biosext.h"
 #include "amiga.h"
+#include "bootprof.h"
+#include "ktrace.h"
 
 #if CONF_WITH_ADVANCED_CPU
 UBYTE is_bus32; /* 1 if address bus is 32-bit, 0 if it is 24-bit */
@@ -830,6 +832,20 @@ void fill_cookie_jar(void)
      * interrupt vector so FreeMiNT can hook it. */
     cookie_add(COOKIE__5MS, (ULONG)&vector_5ms);
 #endif
+
+#if CONF_WITH_BOOT_PROFILER
+    cookie_add(COOKIE_BOOTPROF, (ULONG)&bootprof);
+#endif
+
+#if CONF_WITH_IO_STATS
+    cookie_add(COOKIE_IOSTATS, (ULONG)&iostats);
+#endif
+#if CONF_WITH_IDLE_STATS
+    cookie_add(COOKIE_IDLESTATS, (ULONG)&idlestats);
+#endif
+#if CONF_WITH_KTRACE
+    cookie_add(COOKIE_KTRACE, (ULONG)&ktrace);
+#endif
 }
 
 static const char * guess_machine_name(void)
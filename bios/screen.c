@@ -44,12 +44,24 @@
 
 void detect_monitor_change(void);
 static void setphys(const UBYTE *addr);
+#if CONF_WITH_VIRTUAL_SCROLL && !CONF_VRAM_ADDRESS
+static ULONG calc_vscroll_size(void);
+#endif
 
 #if CONF_WITH_VIDEL
 LONG video_ram_size;        /* these are used by Srealloc() */
 void *video_ram_addr;
 #endif
 
+#if CONF_WITH_VIRTUAL_SCROLL
+/*
+ * the area of screen memory within which the VT52 console may move the
+ * screen base when scrolling.  vscroll_end is NULL if this is not possible.
+ */
+static UBYTE *vscroll_start;
+static UBYTE *vscroll_end;
+#endif
+
 #if CONF_WITH_ATARI_VIDEO
 
 /* Define palette */
@@ -653,6 +665,16 @@ void screen_init_address(void)
     screen_start = (UBYTE *)CONF_VRAM_ADDRESS;
 #else
     vram_size = calc_vram_size();
+#if CONF_WITH_VIRTUAL_SCROLL
+    vscroll_end = NULL;
+    if (!HAS_VIDEL) {   /* Srealloc() may move the screen, so don't bother */
+        ULONG extra = calc_vscroll_size();
+        vram_size += extra;
+        screen_start = balloc_stram(vram_size, TRUE);
+        vscroll_start = screen_start;
+        vscroll_end = screen_start + extra + (ULONG)BYTES_LIN * V_REZ_VT;
+    } else
+#endif
     /* videoram is placed just below the phystop */
     screen_start = balloc_stram(vram_size, TRUE);
 #endif /* CONF_VRAM_ADDRESS */
@@ -781,6 +803,63 @@ ULONG calc_vram_size(void)
 #endif
 }
 
+#if CONF_WITH_VIRTUAL_SCROLL && !CONF_VRAM_ADDRESS
+
+/*
+ * Calculate the amount of extra screen memory for virtual scrolling:
+ * half a screen, rounded up to a multiple of 256 bytes for the ST
+ * shifter.  This means that the whole screen is copied once every
+ * (rows/2) scrolls, rather than on every scroll.
+ */
+static ULONG calc_vscroll_size(void)
+{
+    return ((ULONG)BYTES_LIN * V_REZ_VT / 2 + 255UL) & ~255UL;
+}
+
+#endif
+
+#if CONF_WITH_VIRTUAL_SCROLL
+
+/*
+ * Get the screen memory within which the VT52 console may scroll by
+ * moving the screen base.  'step' is the amount by which the base
+ * would be moved.
+ *
+ * Returns FALSE if this is not possible, for example because the screen
+ * is not in the memory allocated by the BIOS (after Setscreen()), the
+ * logical & physical screens differ, or the video hardware cannot
+ * handle the alignment.
+ */
+BOOL vscroll_get_area(ULONG step, UBYTE **start, UBYTE **end)
+{
+    if (!vscroll_end || rez_was_hacked)
+        return FALSE;
+
+    if ((v_bas_ad < vscroll_start) || (v_bas_ad >= vscroll_end)
+     || (v_bas_ad != physbase()))
+        return FALSE;
+
+    /* the ST shifter only handles screen addresses on 256-byte boundaries */
+    if ((step & 0xff) && !HAS_STE_SHIFTER && !HAS_TT_SHIFTER)
+        return FALSE;
+
+    *start = vscroll_start;
+    *end = vscroll_end;
+
+    return TRUE;
+}
+
+/*
+ * Set a new (logical & physical) screen base for the VT52 console
+ */
+void vscroll_set_base(UBYTE *base)
+{
+    v_bas_ad = base;
+    setphys(base);
+}
+
+#endif /* CONF_WITH_VIRTUAL_SCROLL */
+
 static void shifter_get_current_mode_info(UWORD *planes, UWORD *hz_rez, UWORD *vt_rez)
 {
     WORD vmode;                         /* video mode */
@@ -104,4 +104,9 @@ void setpalette(const UWORD *palettePtr);
 WORD setcolor(WORD colorNum, WORD color);
 void vsync(void);
 
+#if CONF_WITH_VIRTUAL_SCROLL
+BOOL vscroll_get_area(ULONG step, UBYTE **start, UBYTE **end);
+void vscroll_set_base(UBYTE *base);
+#endif
+
 #endif /* SCREEN_H */
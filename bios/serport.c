@@ -14,6 +14,7 @@
 
 #include "emutos.h"
 #include "asm.h"
+#include "biosext.h"
 #include "chardev.h"
 #include "cookie.h"
 #include "delay.h"
@@ -250,7 +251,7 @@ static LONG bconin_iorec(EXT_IOREC *iorec)
 {
     /* Wait for character at the serial line */
     while(!bconstat_iorec(iorec))
-        ;
+        idle_wait();
 
     /* Return character... */
     return get_iorecbuf(&iorec->in);
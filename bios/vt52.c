@@ -74,6 +74,7 @@ static void ascii_cr(void);
 static void esc_ch1(WORD);
 static void get_row(WORD);
 static void get_column(WORD);
+static void normal_ascii(WORD);
 
 void blink(void);
 
@@ -159,6 +160,34 @@ void cputc(WORD ch)
 }
 
 
+#if CONF_WITH_BLOCK_CONOUT
+/*
+ * cputs_block - output a run of printable characters (all >= ' ')
+ *
+ * If an escape sequence is in progress, the characters are handled one
+ * by one, since they may end it.
+ */
+void cputs_block(const UBYTE *buf, WORD count)
+{
+    WORD i;
+
+    if (con_state != normal_ascii) {
+        for (i = 0; i < count; i++)
+            cputc(buf[i]);
+        return;
+    }
+
+#if CONF_SERIAL_CONSOLE
+    /* printable characters are not translated in ANSI mode either */
+    for (i = 0; i < count; i++)
+        bconout(1, buf[i]);
+#endif
+
+    ascii_out_block(buf, count);
+}
+#endif
+
+
 /*
  * normal_ascii - state is normal output
  */
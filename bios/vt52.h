@@ -20,5 +20,8 @@ void vt52_init(void);               /* initialize the vt52 console */
 WORD cursconf(WORD, WORD);          /* XBIOS cursor configuration */
 
 void cputc(WORD);
+#if CONF_WITH_BLOCK_CONOUT
+void cputs_block(const UBYTE *buf, WORD count);
+#endif
 
 #endif /* VT52_H */
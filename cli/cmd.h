@@ -43,10 +43,13 @@ extern LONG jmp_xbios(WORD, ...);
 #define jmp_gemdos_l(a,b)       jmp_gemdos((WORD)(a),(LONG)(b))
 #define jmp_gemdos_p(a,b)       jmp_gemdos((WORD)(a),(void*)(b))
 #define jmp_gemdos_ww(a,b,c)    jmp_gemdos((WORD)(a),(WORD)(b),(WORD)(c))
+#define jmp_gemdos_wp(a,b,c)    jmp_gemdos((WORD)(a),(WORD)(b),(void *)(c))
 #define jmp_gemdos_pw(a,b,c)    jmp_gemdos((WORD)(a),(void *)(b),(WORD)(c))
+#define jmp_gemdos_pl(a,b,c)    jmp_gemdos((WORD)(a),(void *)(b),(LONG)(c))
 #define jmp_gemdos_wlp(a,b,c,d) jmp_gemdos((WORD)(a),(WORD)(b),(LONG)(c),(void *)(d))
 #define jmp_gemdos_wpp(a,b,c,d) jmp_gemdos((WORD)(a),(WORD)(b),(void *)(c),(void *)(d))
 #define jmp_gemdos_pww(a,b,c,d) jmp_gemdos((WORD)(a),(void *)(b),(WORD)(c),(WORD)(d))
+#define jmp_gemdos_lww(a,b,c,d) jmp_gemdos((WORD)(a),(LONG)(b),(WORD)(c),(WORD)(d))
 #define jmp_gemdos_wppp(a,b,c,d,e)  jmp_gemdos((WORD)(a),(WORD)(b),(void *)(c),(void *)(d),(void *)(e))
 #define jmp_bios_w(a,b)         jmp_bios((WORD)(a),(WORD)(b))
 #define jmp_bios_ww(a,b,c)      jmp_bios((WORD)(a),(WORD)(b),(WORD)(c))
@@ -57,6 +60,7 @@ extern LONG jmp_xbios(WORD, ...);
 
 #define Dsetdrv(a)          jmp_gemdos_w(0x0e,a)
 #define Dgetdrv()           jmp_gemdos_v(0x19)
+#define Fsetdta(a)          jmp_gemdos_p(0x1a,a)
 #define Fgetdta()           jmp_gemdos_v(0x2f)
 #define Sversion()          jmp_gemdos_v(0x30)
 #define Dfree(a,b)          jmp_gemdos_pw(0x36,a,b)
@@ -69,6 +73,7 @@ extern LONG jmp_xbios(WORD, ...);
 #define Fread(a,b,c)        jmp_gemdos_wlp(0x3f,a,b,c)
 #define Fwrite(a,b,c)       jmp_gemdos_wlp(0x40,a,b,c)
 #define Fdelete(a)          jmp_gemdos_p(0x41,a)
+#define Fseek(a,b,c)        jmp_gemdos_lww(0x42,a,b,c)
 #define Fattrib(a,b,c)      jmp_gemdos_pww(0x43,a,b,c)
 #define Fdup(a)             jmp_gemdos_w(0x45,a)
 #define Fforce(a,b)         jmp_gemdos_ww(0x46,a,b)
@@ -78,6 +83,8 @@ extern LONG jmp_xbios(WORD, ...);
 #define Pexec(a,b,c,d)      jmp_gemdos_wppp(0x4b,a,b,c,d)
 #define Fsfirst(a,b)        jmp_gemdos_pw(0x4e,a,b)
 #define Fsnext()            jmp_gemdos_v(0x4f)
+#define Fsnextm(a,b)        jmp_gemdos_pl(0x50,a,b)
+#define Mstat(a,b)          jmp_gemdos_wp(0x51,a,b)
 #define Frename(a,b,c)      jmp_gemdos_wpp(0x56,a,b,c)
 
 #define Bconstat(a)         jmp_bios_w(0x01,a)
@@ -99,10 +106,17 @@ extern LONG jmp_xbios(WORD, ...);
 #define MAXCMDLINE      125     /* the most amount of real data allowed */
 
 #define IOBUFSIZE       16384L  /* buffer size */
+#define COPYBUF_MAX     524288L /* max cp/mv buffer, to keep ^C responsive */
+#define COPYBUF_RESERVE 16384L  /* memory left free when sizing cp/mv buffer */
+#define MAX_COPY_DEPTH  8       /* maximum directory nesting for cp -r */
+#define DIRBUF_ENTRIES  32      /* directory entries fetched per Fsnextm() */
 
 #define MAX_LINE_SIZE   200L    /* must be greater than the largest screen width */
 #define HISTORY_SIZE    10      /* number of lines of history */
 #define MAX_ARGS        30      /* maximum number of args we can parse */
+#define MAX_SCRIPT_DEPTH 4      /* maximum nesting of script files */
+#define CMDCACHE_SIZE   8       /* entries in command lookup cache (power of 2) */
+#define CMDCACHE_NAMELEN 14     /* max command name length in cache, incl nul */
 
 #define LOCAL           static  /* comment out for testing */
 #define PRIVATE         static  /* comment out for testing */
@@ -136,6 +150,26 @@ extern LONG jmp_xbios(WORD, ...);
 #define TT_LOW          7
 #define BLACK           0x0000          /* for Setcolor() */
 
+/*
+ * timing & I/O statistics stuff
+ */
+#define TICKS_PER_SEC   200L            /* hz_200 */
+#define EIOS_COOKIE     0x45494f53L     /* 'EIOS': EmuTOS I/O counters */
+#define EIDL_COOKIE     0x4549444cL     /* 'EIDL': EmuTOS idle counters */
+#define EKTR_COOKIE     0x454b5452L     /* 'EKTR': EmuTOS kernel event trace */
+
+/*
+ * kernel trace event ids, see include/ktrace.h
+ */
+#define KT_GETBCB       1
+#define KT_RWABS        2
+#define KT_RWABS_DONE   3
+#define KT_PEXEC        4
+#define KT_PEXEC_LOADED 5
+#define KT_PTERM        6
+#define KT_MXALLOC      7
+#define KT_PEXEC_TIMES  8
+
 /*
  *  typedefs
  */
@@ -148,6 +182,68 @@ typedef struct {
     char    d_fname[14];
 } DTA;
 
+typedef struct {                /* returned by Fsnextm() */
+    char    d_resvd;
+    char    d_attrib;
+    WORD    d_time;
+    WORD    d_date;
+    LONG    d_length;
+    char    d_fname[14];
+} DIRENTRY;
+
+#define MSTAT_ST        0       /* Mstat() pools */
+#define MSTAT_ALT       1
+#define MSTAT_BUCKETS   8
+#define MSTAT_OWNERS    8
+
+typedef struct {                /* process memory usage, in MSTAT */
+    void    *o_pd;
+    LONG    o_blocks;
+    LONG    o_bytes;
+} MSTATOWNER;
+
+typedef struct {                /* returned by Mstat() */
+    LONG    ms_freeblocks;
+    LONG    ms_freebytes;
+    LONG    ms_largest;
+    LONG    ms_usedblocks;
+    LONG    ms_usedbytes;
+    LONG    ms_hist[MSTAT_BUCKETS];
+    WORD    ms_owners;
+    MSTATOWNER ms_owner[MSTAT_OWNERS];
+    LONG    ms_osmtotal;
+    LONG    ms_osmused;
+    LONG    ms_osmfails;
+} MSTAT;
+
+typedef struct {                /* pointed to by EIOS cookie */
+    ULONG   bytes_read;
+    ULONG   bytes_written;
+    ULONG   sectors_read;
+    ULONG   sectors_written;
+} IOSTATS;
+
+typedef struct {                /* pointed to by EIDL cookie */
+    ULONG   idle_ticks;
+    ULONG   idle_waits;
+} IDLESTATS;
+
+typedef struct {                /* one event in the kernel trace */
+    ULONG   ticks;
+    UWORD   id;
+    UWORD   seq;
+    ULONG   arg[4];
+} KTRACE_EVENT;
+
+typedef struct {                /* pointed to by EKTR cookie */
+    UWORD   version;
+    UWORD   max;
+    UWORD   hz;
+    UWORD   enabled;
+    ULONG   count;
+    KTRACE_EVENT event[1];      /* actually 'max' events */
+} KTRACE;
+
 /* Type of function run by execute() */
 typedef LONG FUNC(WORD argc,char **argv);
 
@@ -161,6 +257,7 @@ typedef LONG FUNC(WORD argc,char **argv);
 /*
  *  manifest constants
  */
+#define EINVFN          -32
 #define EFILNF          -33
 #define EPTHNF          -34
 #define ENHNDL          -35
@@ -175,6 +272,7 @@ typedef LONG FUNC(WORD argc,char **argv);
 #define CMDLINE_LENGTH  -103
 #define DIR_NOT_EMPTY   -104        /* translated from EACCDN for folders */
 #define CANT_DELETE     -105        /* translated from EACCDN for files */
+#define SCRIPT_DEPTH    -106        /* script files nested too deeply */
 #define CHANGE_RES      -125        /* returned by mode command */
 #define INVALID_PARAM   -126        /* for builtin commands */
 #define WRONG_NUM_ARGS  -127        /* for builtin commands */
@@ -197,6 +295,7 @@ typedef LONG FUNC(WORD argc,char **argv);
 
 #define LOOKUP_EXIT     (FUNC *)-1L     /* special return values from lookup_builtin() */
 #define LOOKUP_ARGS     (FUNC *)-2L
+#define LOOKUP_TIME     (FUNC *)-3L
 
 /*
  *  global variables
@@ -210,11 +309,13 @@ extern DTA *dta;
 extern LONG redir_handle;
 extern char user_path[MAXPATHLEN];     /* from PATH command */
 extern char *environment;              /* from cmdasm.S */
+extern char *cmdtail;                  /* from cmdasm.S */
 
 /*
  *  function prototypes
  */
 /* cmdmain.c */
+LONG run_script(const char *path,WORD argc,char **argv);
 int valid_res(WORD res);
 
 /* cmdedit.c */
@@ -226,6 +327,7 @@ void save_history(const char *line);
 
 /* cmdexec.c */
 LONG exec_program(WORD argc,char **argv,char *redir_name);
+void invalidate_cmd_cache(void);
 
 /* cmdint.c */
 LONG get_path(char *buf,WORD drive);
@@ -238,7 +340,12 @@ WORD parse_line(char *line,char **argv,char *redir_name);
 WORD decode_date_time(char *s,UWORD date,UWORD time);
 void errmsg(LONG rc);
 void escape(char c);
+void format_ticks(char *buf,ULONG ticks);
 WORD getcookie(LONG cookie,LONG *pvalue);
+WORD get_idlestats(IDLESTATS *stats);
+KTRACE *get_ktrace(void);
+WORD get_iostats(IOSTATS *stats);
+ULONG get_ticks(void);
 WORD getword(char *buf);
 WORD get_path_component(const char **pp,char *dest);
 WORD has_wildcard(const char *name);
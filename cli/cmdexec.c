@@ -14,6 +14,25 @@
 
 static UWORD old_stdout;
 
+/*
+ *  command lookup cache
+ *
+ *  this remembers where commands were found when searching the user
+ *  path, so that subsequent executions do not need to search again.
+ *  it is a small direct-mapped hash table, keyed by the command name;
+ *  only absolute paths are cached.  a cached entry is checked with a
+ *  single Fsfirst() before it is used, and the whole cache is discarded
+ *  when the search path is changed, when a builtin command modifies a
+ *  directory, or after an external program has run, since it may have
+ *  done the same.
+ */
+typedef struct {
+    char name[CMDCACHE_NAMELEN];    /* command name as typed, empty if unused */
+    char path[MAXPATHLEN];          /* full path of executable */
+} CMDCACHE;
+
+LOCAL CMDCACHE cmd_cache[CMDCACHE_SIZE];
+
 /*
  *  function prototypes
  */
@@ -21,9 +40,13 @@ PRIVATE void add_to_path(char *path,const char *name);
 PRIVATE WORD build_cmdline(char *cmdline,WORD argc,char **argv);
 PRIVATE WORD check_user_path(char *path,const char *name);
 PRIVATE WORD find_executable(char *fullname,const char *name);
+PRIVATE CMDCACHE *hash_cmd(const char *name);
 PRIVATE WORD is_graphical(const char *name);
+PRIVATE WORD is_script(const char *name);
+PRIVATE WORD lookup_cmd_cache(char *path,const char *name);
 PRIVATE LONG redirect_stdout(char *redir);
 PRIVATE void restore_stdout(char *redir);
+PRIVATE void save_cmd_cache(const char *path,const char *name);
 
 
 LONG exec_program(WORD argc,char **argv,char *redir)
@@ -40,8 +63,17 @@ LONG rc;
 
     if (find_executable(path,argv[0]) == 0)
         ;
+    else if (lookup_cmd_cache(path,argv[0]) == 0)
+        ;
     else if (check_user_path(path,argv[0]) < 0)
         return EFILNF;
+    else save_cmd_cache(path,argv[0]);
+
+    if (is_script(path)) {
+        if (redir[0])           /* redirecting a whole script is not supported */
+            return INVALID_PARAM;
+        return run_script(path,argc,argv);
+    }
 
     rc = redirect_stdout(redir);
     if (rc < 0L)
@@ -51,12 +83,86 @@ LONG rc;
         (void)Cursconf(0,0);
     rc = Pexec(0,path,cmdline,NULL);
     (void)Cursconf(1,0);
+    invalidate_cmd_cache();     /* the program may have changed directories */
 
     restore_stdout(redir);
 
     return rc;
 }
 
+/*
+ *  discard the contents of the command lookup cache
+ */
+void invalidate_cmd_cache(void)
+{
+WORD i;
+
+    for (i = 0; i < CMDCACHE_SIZE; i++)
+        cmd_cache[i].name[0] = '\0';
+}
+
+/*
+ *  return the cache slot for a command name
+ */
+PRIVATE CMDCACHE *hash_cmd(const char *name)
+{
+const char *p;
+UWORD hash;
+
+    for (p = name, hash = 0; *p; p++)
+        hash = hash * 31 + (*p | 0x20);     /* names are case-insensitive */
+
+    return &cmd_cache[hash & (CMDCACHE_SIZE-1)];
+}
+
+/*
+ *  look up command in cache
+ *
+ *  if found and the executable still exists, 'path' contains the full
+ *  path, rc = 0
+ */
+PRIVATE WORD lookup_cmd_cache(char *path,const char *name)
+{
+CMDCACHE *c;
+
+    c = hash_cmd(name);
+    if (!c->name[0] || !strequal(name,c->name))
+        return -1;
+
+    if (Fsfirst(c->path,0x07) != 0) {   /* gone: forget it */
+        c->name[0] = '\0';
+        return -1;
+    }
+
+    strcpy(path,c->path);
+
+    return 0;
+}
+
+/*
+ *  remember where a command was found
+ *
+ *  only simple names that resolve to absolute paths are cached
+ */
+PRIVATE void save_cmd_cache(const char *path,const char *name)
+{
+CMDCACHE *c;
+const char *p;
+
+    if ((path[1] != DRIVESEP) || (path[2] != PATHSEP))
+        return;
+
+    for (p = name; *p; p++)
+        if ((*p == PATHSEP) || (*p == DRIVESEP))
+            return;
+    if (p - name >= CMDCACHE_NAMELEN)
+        return;
+
+    c = hash_cmd(name);
+    strcpy(c->name,name);
+    strcpy(c->path,path);
+}
+
 /*
  *  add filename to path
  */
@@ -193,6 +299,23 @@ const char *p;
     return 0;
 }
 
+/*
+ *  test if program is a script file
+ */
+PRIVATE WORD is_script(const char *name)
+{
+const char *p;
+
+    for (p = name; *p; p++)
+        ;
+    p -= 4;         /* back up to putative period */
+
+    if ((p < name) || (*p++ != '.'))
+        return 0;
+
+    return strequal(p,"bat");
+}
+
 /*
  *  redirect stdout with Fdup()/Fforce()
  */
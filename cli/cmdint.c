@@ -21,16 +21,39 @@ typedef struct {
     const char * const *help;
 } COMMAND;
 
+typedef struct {
+    char *buf;                  /* cp/mv buffer */
+    LONG bufsize;
+    ULONG files;                /* statistics for final report */
+    ULONG bytes;
+    ULONG start;
+} COPYINFO;
+
 /*
  *  function prototypes
  */
+PRIVATE LONG bench_console(void);
+PRIVATE LONG bench_create(char *name,char *p,WORD nfiles,WORD delete);
+PRIVATE LONG bench_list(char *name,char *p);
+PRIVATE LONG bench_read(const char *name,char *iobuf);
+PRIVATE void bench_report(const char *title,ULONG ticks,WORD kbytes);
+PRIVATE LONG bench_write(const char *name,char *iobuf,WORD kbytes);
+PRIVATE LONG alloc_copybuf(COPYINFO *ci,const char *src,const char *dst);
 PRIVATE LONG check_path_component(char *component);
+PRIVATE LONG cluster_size(const char *path);
+PRIVATE LONG copy_file(COPYINFO *ci,const char *inname,const char *outname);
 PRIVATE LONG copy_move(WORD argc,char **argv,WORD delete);
+PRIVATE LONG copy_recursive(char *srcarg,char *dstarg);
+PRIVATE void copy_report(COPYINFO *ci);
+PRIVATE LONG copy_tree(COPYINFO *ci,char *src,char *dst,WORD depth);
+PRIVATE LONG dir_first(const char *spec,WORD attr);
+PRIVATE LONG dir_next(void);
 PRIVATE void display_dta_detail(void);
 PRIVATE char *extract_path(char *dest,const char *src);
 PRIVATE void fixup_filespec(char *filespec);
 PRIVATE char getyn(void);
 PRIVATE void help_display(const COMMAND *p);
+PRIVATE void mem_report(const char *title,const MSTAT *ms);
 PRIVATE WORD help_lines(const COMMAND *p);
 PRIVATE WORD help_pause(void);
 PRIVATE WORD help_wanted(const COMMAND *p,char *cmd);
@@ -41,9 +64,12 @@ PRIVATE LONG outputbuf(const char *s,LONG len,WORD paging);
 PRIVATE LONG output_files(WORD argc,char **argv,WORD paging);
 PRIVATE void padname(char *buf,const char *name);
 PRIVATE void show_line(const char *title,ULONG n);
+PRIVATE void strip_sep(char *path);
+PRIVATE void trace_line(char *buf,const KTRACE_EVENT *e,ULONG start,UWORD hz);
 PRIVATE WORD user_break(void);
 PRIVATE WORD user_input(WORD c);
 
+PRIVATE LONG run_bench(WORD argc,char **argv);
 PRIVATE LONG run_cat(WORD argc,char **argv);
 PRIVATE LONG run_cd(WORD argc,char **argv);
 PRIVATE LONG run_chmod(WORD argc,char **argv);
@@ -52,6 +78,7 @@ PRIVATE LONG run_cp(WORD argc,char **argv);
 PRIVATE LONG run_echo(WORD argc,char **argv);
 PRIVATE LONG run_help(WORD argc,char **argv);
 PRIVATE LONG run_ls(WORD argc,char **argv);
+PRIVATE LONG run_mem(WORD argc,char **argv);
 PRIVATE LONG run_mkdir(WORD argc,char **argv);
 PRIVATE LONG run_more(WORD argc,char **argv);
 PRIVATE LONG run_mode(WORD argc,char **argv);
@@ -63,12 +90,25 @@ PRIVATE LONG run_rm(WORD argc,char **argv);
 PRIVATE LONG run_rmdir(WORD argc,char **argv);
 PRIVATE LONG run_setdrv(WORD argc,char **argv);
 PRIVATE LONG run_show(WORD argc,char **argv);
+PRIVATE LONG run_trace(WORD argc,char **argv);
 PRIVATE LONG run_version(WORD argc,char **argv);
 PRIVATE LONG run_wrap(WORD argc,char **argv);
 
+/*
+ *  directory entries fetched by dir_next()
+ */
+LOCAL DIRENTRY dirbuf[DIRBUF_ENTRIES];
+LOCAL WORD dirbuf_count, dirbuf_next;
+LOCAL WORD no_fsnextm;                  /* TRUE if Fsnextm() is not available */
+
 /*
  *  help strings
  */
+LOCAL const char * const help_bench[] = { "[-c] [<dir> [<kbytes> [<files>]]]",
+    N_("Run file system benchmarks in <dir>:"),
+    N_("write & read a file of <kbytes> KB (default 256),"),
+    N_("create, list & delete <files> files (default 32)"),
+    N_("Specify -c for a console output benchmark instead"), NULL };
 LOCAL const char * const help_cat[] = { "<filespec> ...",
     N_("Copy <filespec> ... to standard output"), NULL };
 LOCAL const char * const help_cd[] = { "[<dir>]",
@@ -80,10 +120,11 @@ LOCAL const char * const help_chmod[] = { "<mode> <filename>",
     N_("r=read-only  h=hidden  s=system  -=none"), NULL };
 LOCAL const char * const help_cls[] = { "",
     N_("Clear screen"), NULL };
-LOCAL const char * const help_cp[] = { "<filespec> <dest>",
+LOCAL const char * const help_cp[] = { "[-r] <filespec> <dest>",
     N_("Copy files matching <filespec> to <dest>"),
     N_("If <filespec> matches multiple files,"),
-    N_("<dest> must be a directory"), NULL };
+    N_("<dest> must be a directory"),
+    N_("Specify -r to copy directory <filespec> and its contents"), NULL };
 LOCAL const char * const help_echo[] = { "<string> ...",
     N_("Copy <string> ... to standard output"),
     N_("Strings may be surrounded by \"\""), NULL };
@@ -96,6 +137,9 @@ LOCAL const char * const help_help[] = { "[<cmd>]",
 LOCAL const char * const help_ls[] = { "[-l] <path>",
     N_("List files (default terse, horizontal)"),
     N_("Specify -l for detailed list"), NULL };
+LOCAL const char * const help_mem[] = { "[st|alt]",
+    N_("Show memory pool usage & fragmentation"),
+    N_("for ST RAM and/or alternate RAM"), NULL };
 LOCAL const char * const help_mkdir[] = { "<dir>",
     N_("Create directory <dir>"), NULL };
 LOCAL const char * const help_mode[] = { "con[:] [res=<r>] [delay=<m>] [rate=<n>]",
@@ -122,6 +166,13 @@ LOCAL const char * const help_rmdir[] = { "<dir>",
     N_("Delete directory <dir>"), NULL };
 LOCAL const char * const help_show[] = { "[<drive>]",
     N_("Show info for <drive> or current drive"), NULL };
+LOCAL const char * const help_time[] = { "<cmd> ...",
+    N_("Execute <cmd>, then display the elapsed time,"),
+    N_("the number of bytes & sectors read/written"),
+    N_("and the time spent idle waiting for input"), NULL };
+LOCAL const char * const help_trace[] = { "[on|off|clear]",
+    N_("Display the kernel event trace, or"),
+    N_("start/stop/clear recording of events"), NULL };
 LOCAL const char * const help_version[] = { "",
     N_("Display GEMDOS version"), NULL };
 LOCAL const char * const help_wrap[] = { "[on|off]",
@@ -138,15 +189,17 @@ LOCAL const char * const help_edit[] = {
  *  command table
  */
 LOCAL const COMMAND cmdtable[] = {
+    { "bench", NULL, 0, 3, run_bench, help_bench },
     { "cat", "type", 1, 255, run_cat, help_cat },
     { "cd", NULL, 0, 1, run_cd, help_cd },
     { "chmod", NULL, 2, 2, run_chmod, help_chmod },
     { "cls", "clear", 0, 0, run_cls, help_cls },
-    { "cp", "copy", 2, 2, run_cp, help_cp },
+    { "cp", "copy", 2, 3, run_cp, help_cp },
     { "echo", NULL, 0, 255, run_echo, help_echo },
     { "exit", NULL, 0, 0, LOOKUP_EXIT, help_exit },
     { "help", NULL, 0, 1, run_help, help_help },
     { "ls", "dir", 0, 2, run_ls, help_ls },
+    { "mem", NULL, 0, 1, run_mem, help_mem },
     { "mkdir", "md", 1, 1, run_mkdir, help_mkdir },
     { "mode", NULL, 1, 4, run_mode, help_mode },
     { "more", NULL, 1, 1, run_more, help_more },
@@ -157,6 +210,8 @@ LOCAL const COMMAND cmdtable[] = {
     { "rm", "del", 1, 2, run_rm, help_rm },
     { "rmdir", "rd", 1, 1, run_rmdir, help_rmdir },
     { "show", NULL, 0, 1, run_show, help_show },
+    { "time", NULL, 1, 255, LOOKUP_TIME, help_time },
+    { "trace", NULL, 0, 1, run_trace, help_trace },
     { "version", NULL, 0, 0, run_version, help_version },
     { "wrap", NULL, 0, 1, run_wrap, help_wrap },
     { "", NULL, 0, 255, NULL, NULL }                    /* end marker */
@@ -164,6 +219,11 @@ LOCAL const COMMAND cmdtable[] = {
 
 static LONG linecount;  /* used by 'more' command */
 
+#define BENCH_KBYTES    256     /* defaults for 'bench' command */
+#define BENCH_CONLINES  200     /* lines output by 'bench -c' */
+#define BENCH_CONWIDTH  64      /*  and their length */
+#define BENCH_FILES     32
+
 LONG (*lookup_builtin(WORD argc,char **argv))(WORD,char **)
 {
 const COMMAND *p;
@@ -204,6 +264,61 @@ const COMMAND *p;
     return p->func;
 }
 
+PRIVATE LONG run_bench(WORD argc,char **argv)
+{
+char name[MAXPATHLEN];
+char *p, *iobuf;
+WORD kbytes = BENCH_KBYTES, nfiles = BENCH_FILES;
+LONG rc;
+
+    if ((argc == 2) && strequal(argv[1],"-c"))
+        return bench_console();
+
+    name[0] = '\0';
+    if (argc > 1) {
+        strcpy(name,argv[1]);
+        p = name + strlen(name);
+        if ((*(p-1) != PATHSEP) && (*(p-1) != DRIVESEP)) {
+            *p++ = PATHSEP;
+            *p = '\0';
+        }
+    }
+    if (argc > 2) {
+        kbytes = getword(argv[2]);
+        if (kbytes <= 0)
+            return INVALID_PARAM;
+    }
+    if (argc > 3) {
+        nfiles = getword(argv[3]);
+        if ((nfiles <= 0) || (nfiles > 999))
+            return INVALID_PARAM;
+    }
+    p = name + strlen(name);
+
+    iobuf = (char *)Malloc(IOBUFSIZE);
+    if (!iobuf)
+        return ENSMEM;
+    memset(iobuf,0xa5,IOBUFSIZE);
+
+    strcpy(p,"BENCH.TMP");
+    rc = bench_write(name,iobuf,kbytes);
+    if (rc == 0L)
+        rc = bench_read(name,iobuf);
+    Fdelete(name);
+
+    if (rc == 0L)
+        rc = bench_create(name,p,nfiles,0);
+    if (rc == 0L)
+        rc = bench_list(name,p);
+    if (rc == 0L)
+        rc = bench_create(name,p,nfiles,1);
+    else bench_create(name,p,nfiles,-1);    /* just clean up */
+
+    Mfree(iobuf);
+
+    return rc;
+}
+
 PRIVATE LONG run_cat(WORD argc,char **argv)
 {
     return output_files(argc,argv,0);
@@ -297,6 +412,14 @@ PRIVATE LONG run_cls(WORD argc,char **argv)
 
 PRIVATE LONG run_cp(WORD argc,char **argv)
 {
+    invalidate_cmd_cache();
+
+    if (argc == 4) {
+        if (!strequal(argv[1],"-r"))
+            return INVALID_PARAM;
+        return copy_recursive(argv[2],argv[3]);
+    }
+
     return copy_move(argc,argv,0);
 }
 
@@ -385,7 +508,7 @@ WORD detail = 0;
         output(_("Listing of "));
         outputnl(filespec);
     }
-    for (rc = Fsfirst(filespec,0x17), n = 0; rc == 0; rc = Fsnext()) {
+    for (rc = dir_first(filespec,0x17), n = 0; rc == 0; rc = dir_next()) {
         if (constat())
             if (user_input(-1))
                 return USER_BREAK;
@@ -409,8 +532,46 @@ WORD detail = 0;
     return rc;
 }
 
+PRIVATE LONG run_mem(WORD argc,char **argv)
+{
+MSTAT ms;
+WORD st = TRUE, alt = TRUE;
+
+    if (argc > 1) {
+        if (strequal(argv[1],"ST"))
+            alt = FALSE;
+        else if (strequal(argv[1],"ALT"))
+            st = FALSE;
+        else return INVALID_PARAM;
+    }
+
+    if (Mstat(MSTAT_ST,&ms) == EINVFN) {
+        messagenl(_("Memory statistics are not available"));
+        return 0L;
+    }
+    if (st)
+        mem_report(_("ST RAM"),&ms);
+
+    if (alt) {
+        if (Mstat(MSTAT_ALT,&ms) == 0)
+            mem_report(_("Alternate RAM"),&ms);
+        else if (!st)
+            messagenl(_("No alternate RAM"));
+    }
+
+    /* the OS pool info is the same for all pools */
+    outputnl(_("OS internal memory"));
+    show_line(_("  Total blocks:   "),ms.ms_osmtotal);
+    show_line(_("  Blocks used:    "),ms.ms_osmused);
+    show_line(_("  Times exhausted:"),ms.ms_osmfails);
+
+    return 0L;
+}
+
 PRIVATE LONG run_mkdir(WORD argc,char **argv)
 {
+    invalidate_cmd_cache();
+
     return Dcreate(argv[1]);
 }
 
@@ -469,6 +630,8 @@ PRIVATE LONG run_more(WORD argc,char **argv)
 
 PRIVATE LONG run_mv(WORD argc,char **argv)
 {
+    invalidate_cmd_cache();
+
     return copy_move(argc,argv,1);
 }
 
@@ -484,6 +647,7 @@ const char *p;
         messagenl(p);
     } else {
         strcpy(user_path,argv[1]);
+        invalidate_cmd_cache();
     }
 
     return 0L;
@@ -502,6 +666,8 @@ LONG rc;
 
 PRIVATE LONG run_ren(WORD argc,char **argv)
 {
+    invalidate_cmd_cache();
+
     return Frename(0,argv[1],argv[2]);
 }
 
@@ -522,6 +688,8 @@ LONG rc;
     if (argc == 0)
         return 0L;
 
+    invalidate_cmd_cache();
+
     if (has_wildcard(*argv)) {
         message(_("Delete ALL matching files"));
         if (getyn() != 'y')
@@ -553,6 +721,8 @@ PRIVATE LONG run_rmdir(WORD argc,char **argv)
 {
 LONG rc;
 
+    invalidate_cmd_cache();
+
     rc = Ddelete(argv[1]);
 
     return (rc==EACCDN) ? DIR_NOT_EMPTY : rc;
@@ -603,6 +773,50 @@ char id[] = "X:";
     return rc;
 }
 
+PRIVATE LONG run_trace(WORD argc,char **argv)
+{
+KTRACE *kt;
+ULONG n, start;
+UWORD enabled;
+LONG rc = 0L;
+char buf[80];
+
+    kt = get_ktrace();
+    if (!kt) {
+        messagenl(_("Kernel trace is not available"));
+        return 0L;
+    }
+
+    if (argc > 1) {
+        if (strequal(argv[1],"ON"))
+            kt->enabled = 1;
+        else if (strequal(argv[1],"OFF"))
+            kt->enabled = 0;
+        else if (strequal(argv[1],"CLEAR"))
+            kt->count = 0;
+        else return INVALID_PARAM;
+        return 0L;
+    }
+
+    enabled = kt->enabled;
+    kt->enabled = 0;            /* don't trace ourselves */
+
+    n = (kt->count > kt->max) ? kt->count - kt->max : 0;
+    start = kt->event[n%kt->max].ticks;
+    for ( ; n < kt->count; n++) {
+        if (constat() && user_break()) {
+            rc = USER_BREAK;
+            break;
+        }
+        trace_line(buf,&kt->event[n%kt->max],start,kt->hz);
+        outputnl(buf);
+    }
+
+    kt->enabled = enabled;
+
+    return rc;
+}
+
 PRIVATE LONG run_version(WORD argc,char **argv)
 {
 UWORD n;
@@ -780,6 +994,138 @@ LONG rc = 0L;
     return rc;
 }
 
+/*
+ *  return the cluster size in bytes of the drive containing 'path',
+ *  or 0 if unknown
+ */
+PRIVATE LONG cluster_size(const char *path)
+{
+ULONG info[4];
+WORD drive;
+
+    if (path[0] && (path[1] == DRIVESEP))
+        drive = (path[0] | 0x20) - 'a';
+    else drive = Dgetdrv();
+
+    if (Dfree(info,drive+1) < 0L)
+        return 0L;
+
+    return info[2] * info[3];
+}
+
+/*
+ *  allocate the buffer for cp/mv
+ *
+ *  the buffer is as large as memory allows (up to COPYBUF_MAX), and is
+ *  a multiple of the cluster size of both the source & destination
+ *  drives.  since the copy always starts at the beginning of the file,
+ *  each Fread()/Fwrite() then transfers whole clusters, which the BDOS
+ *  can do directly to/from the buffer without going through its cache.
+ *
+ *  note that GEMDOS I/O is synchronous, so there is nothing to be
+ *  gained by double-buffering: a single large buffer minimises the
+ *  number of calls (and head movements between source & destination).
+ */
+PRIVATE LONG alloc_copybuf(COPYINFO *ci,const char *src,const char *dst)
+{
+LONG size, clsize, n;
+
+    clsize = cluster_size(src);
+    n = cluster_size(dst);
+    if (n > clsize)             /* cluster sizes are powers of 2 */
+        clsize = n;
+
+    size = Malloc(-1L) - COPYBUF_RESERVE;
+    if (size > COPYBUF_MAX)
+        size = COPYBUF_MAX;
+    if (clsize > 0L)
+        size -= size % clsize;
+    if (size < IOBUFSIZE)
+        size = IOBUFSIZE;
+
+    ci->buf = (char *)Malloc(size);
+    if (!ci->buf)
+        return ENSMEM;
+
+    ci->bufsize = size;
+    ci->files = 0L;
+    ci->bytes = 0L;
+    ci->start = get_ticks();
+
+    return 0L;
+}
+
+/*
+ *  display the number of files & bytes copied, with the throughput
+ */
+PRIVATE void copy_report(COPYINFO *ci)
+{
+char buf[80], secs[20];
+ULONG ticks;
+
+    if (ci->files == 0L)
+        return;
+
+    ticks = get_ticks() - ci->start;
+    format_ticks(secs,ticks);
+    if (ticks == 0)             /* avoid dividing by zero */
+        ticks = 1;
+    sprintf(buf,_("%lu file(s), %lu bytes in %s s (%lu KB/s)"),
+            ci->files,ci->bytes,secs,(ci->bytes/1024)*TICKS_PER_SEC/ticks);
+    messagenl(buf);
+}
+
+/*
+ *  copy one file, using the buffer in 'ci'
+ *
+ *  if the copy fails, the output file is deleted
+ */
+PRIVATE LONG copy_file(COPYINFO *ci,const char *inname,const char *outname)
+{
+WORD in, out;
+LONG n, rc;
+
+    rc = Fopen(inname,0);
+    if (rc < 0L)
+        return rc;
+    in = LOWORD(rc);
+
+    rc = Fcreate(outname,0);
+    if (rc < 0L) {
+        Fclose(in);
+        return rc;
+    }
+    out = LOWORD(rc);
+
+    do {
+        /* allow user to interrupt during file copy/move */
+        if (constat()) {
+            if (user_break()) {
+                rc = USER_BREAK;
+                break;
+            }
+        }
+        n = rc = Fread(in,ci->bufsize,ci->buf);
+        if (rc < 0L)
+            break;
+        rc = Fwrite(out,n,ci->buf);
+        if (rc < 0L)
+            break;
+        if (rc != n)
+            rc = DISK_FULL;
+        else ci->bytes += n;
+    } while(rc > 0L);
+    Fclose(in);
+    Fclose(out);
+
+    /* if the copy failed, delete the output to avoid an incomplete file */
+    if (rc < 0L)
+        Fdelete(outname);
+    else ci->files++;
+
+    return rc;
+}
+
 /*
  *  copy_move
  */
@@ -787,9 +1133,9 @@ PRIVATE LONG copy_move(WORD argc,char **argv,WORD delete)
 {
 char inname[MAXPATHLEN], outname[MAXPATHLEN], fullname[MAXPATHLEN];
 char *inptr, *outptr;
-WORD in, out, output_is_dir = 0;
-char *iobuf;
-LONG bufsize, n, rc;
+WORD output_is_dir = 0;
+COPYINFO ci;
+LONG n, rc;
 
     inptr = extract_path(inname,argv[1]);
     outptr = extract_path(outname,argv[2]);
@@ -831,10 +1177,9 @@ LONG bufsize, n, rc;
         *outptr = '\0';
     }
 
-    bufsize = IOBUFSIZE;
-    iobuf = (char *)Malloc(bufsize);
-    if (!iobuf)
-        return ENSMEM;
+    rc = alloc_copybuf(&ci,inname,outname);
+    if (rc < 0L)
+        return rc;
 
     for (rc = Fsfirst(inname,0x07); rc == 0; rc = Fsnext()) {
         /* allow user to interrupt or pause before every file copy/move */
@@ -860,41 +1205,7 @@ LONG bufsize, n, rc;
         message(_(" to "));
         message(outname);
 
-        rc = Fopen(inname,0);
-        if (rc < 0L)
-            break;
-        in = LOWORD(rc);
-
-        rc = Fcreate(outname,0);
-        if (rc < 0L) {
-            Fclose(in);
-            break;
-        }
-        out = LOWORD(rc);
-
-        do {
-            /* allow user to interrupt during file copy/move */
-            if (constat()) {
-                if (user_break()) {
-                    rc = USER_BREAK;
-                    break;
-                }
-            }
-            n = rc = Fread(in,bufsize,iobuf);
-            if (rc < 0L)
-                break;
-            rc = Fwrite(out,n,iobuf);
-            if (rc < 0L)
-                break;
-            if (rc != n)
-                rc = DISK_FULL;
-        } while(rc > 0L);
-        Fclose(in);
-        Fclose(out);
-
-        /* if the copy failed, delete the output to avoid an incomplete file */
-        if (rc < 0L)
-            Fdelete(outname);
+        rc = copy_file(&ci,inname,outname);
 
         if (delete && (rc == 0L)) { /* don't delete unless copy successful */
             message(_(" ... deleting "));
@@ -912,11 +1223,445 @@ LONG bufsize, n, rc;
     if (rc == ENMFIL)   /* not really an error */
         rc = 0L;
 
-    Mfree(iobuf);
+    if (rc == 0L)
+        copy_report(&ci);
+
+    Mfree(ci.buf);
+
+    return rc;
+}
+
+/*
+ *  copy the contents of directory 'src' to directory 'dst', creating
+ *  'dst' if necessary, and recursing into subdirectories
+ *
+ *  both names are absolute paths without a trailing separator; they are
+ *  extended in place during processing, so the buffers must be MAXPATHLEN
+ *  long.  each level uses its own DTA so that the Fsfirst()/Fsnext()
+ *  sequence of the caller is not disturbed.
+ */
+PRIVATE LONG copy_tree(COPYINFO *ci,char *src,char *dst,WORD depth)
+{
+DTA local_dta, *save_dta;
+char *srcend, *dstend;
+LONG rc;
+
+    srcend = src + strlen(src);
+    dstend = dst + strlen(dst);
+    if ((depth > MAX_COPY_DEPTH)
+     || (srcend-src+1+sizeof(local_dta.d_fname) > MAXPATHLEN)
+     || (dstend-dst+1+sizeof(local_dta.d_fname) > MAXPATHLEN))
+        return EPTHNF;
+
+    /* switch DTA first: check_path_component() uses Fsfirst() */
+    save_dta = dta;
+    dta = &local_dta;
+    Fsetdta(dta);
+
+    rc = Dcreate(dst);
+    if ((rc < 0L) && (check_path_component(dst) == 0L))
+        rc = 0L;                /* it already exists */
+    if (rc < 0L) {
+        dta = save_dta;
+        Fsetdta(dta);
+        return rc;
+    }
+
+    *dstend = PATHSEP;
+    strcpy(srcend,"\\*.*");
+
+    for (rc = Fsfirst(src,0x17); rc == 0; rc = Fsnext()) {
+        if (constat()) {
+            if (user_input(-1)) {
+                rc = USER_BREAK;
+                break;
+            }
+        }
+        if (strequal(local_dta.d_fname,".") || strequal(local_dta.d_fname,".."))
+            continue;
+
+        strcpy(srcend+1,local_dta.d_fname);
+        strcpy(dstend+1,local_dta.d_fname);
+
+        if (local_dta.d_attrib & 0x10) {
+            rc = copy_tree(ci,src,dst,depth+1);
+        } else {
+            message(_("Copying "));
+            message(src);
+            message(_(" to "));
+            message(dst);
+            rc = copy_file(ci,src,dst);
+            if (rc == 0L)
+                messagenl(_(" ... done"));
+            else message(" ... ");
+        }
+        if (rc < 0L)
+            break;
+    }
+    if (rc == ENMFIL)   /* not really an error */
+        rc = 0L;
+
+    *srcend = '\0';
+    *dstend = '\0';
+
+    dta = save_dta;
+    Fsetdta(dta);
+
+    return rc;
+}
+
+/*
+ *  copy a directory tree (cp -r)
+ *
+ *  if <dest> is an existing directory, <dir> is copied into it;
+ *  otherwise <dest> is created as a copy of <dir>
+ */
+PRIVATE LONG copy_recursive(char *srcarg,char *dstarg)
+{
+char src[MAXPATHLEN], dst[MAXPATHLEN];
+char *p, *q, c;
+COPYINFO ci;
+LONG rc, len;
+WORD same;
+
+    rc = make_absolute(src,srcarg);
+    if (rc == 0L)
+        rc = make_absolute(dst,dstarg);
+    if (rc < 0L)
+        return rc;
+
+    /* remove any trailing separator, then check that there is a dirname */
+    strip_sep(src);
+    strip_sep(dst);
+    for (p = NULL, q = src; *q; q++)
+        if (*q == PATHSEP)
+            p = q;
+    if (!p || !p[1])                /* can't copy the root */
+        return INVALID_PARAM;
+
+    rc = check_path_component(src);
+    if (rc < 0L)
+        return rc;
+
+    /* if the target is an existing directory, copy into it */
+    if (check_path_component(dst) == 0L) {
+        if (strlen(dst) + strlen(p) >= MAXPATHLEN)
+            return EPTHNF;
+        q = dst + strlen(dst);
+        if (*(q-1) == PATHSEP)      /* root */
+            p++;
+        strcpy(q,p);
+    }
+
+    /* refuse to copy a directory into itself */
+    len = strlen(src);
+    if ((strlen(dst) >= len) && ((dst[len] == '\0') || (dst[len] == PATHSEP))) {
+        c = dst[len];
+        dst[len] = '\0';
+        same = strequal(src,dst);
+        dst[len] = c;
+        if (same)
+            return INVALID_PARAM;
+    }
+
+    rc = alloc_copybuf(&ci,src,dst);
+    if (rc < 0L)
+        return rc;
+
+    rc = copy_tree(&ci,src,dst,1);
+
+    if (rc == 0L)
+        copy_report(&ci);
+
+    Mfree(ci.buf);
 
     return rc;
 }
 
+/*
+ *  remove a trailing path separator from an absolute path, except
+ *  following the drive separator
+ */
+PRIVATE void strip_sep(char *path)
+{
+char *p;
+
+    p = path + strlen(path) - 1;
+    if ((p > path) && (*p == PATHSEP) && (*(p-1) != DRIVESEP))
+        *p = '\0';
+}
+
+/*
+ *  format one kernel trace event, with its time in ms relative to 'start'
+ */
+PRIVATE void trace_line(char *buf,const KTRACE_EVENT *e,ULONG start,UWORD hz)
+{
+ULONG ms = (e->ticks - start) * 1000L / hz;
+const ULONG *a = e->arg;
+char name[9];
+char *p;
+
+    p = buf + sprintf(buf,"%8lu ",ms);
+
+    switch(e->id) {
+    case KT_GETBCB:
+        sprintf(p,"getbcb  %c: type %lu rec %lu %s",(char)('A'+a[0]),a[1],a[2],
+                a[3] ? "hit" : "miss");
+        break;
+    case KT_RWABS:
+        sprintf(p,"rwabs   %s dev %ld rec %lu count %lu",(a[0]&1) ? "write" : "read",
+                a[1],a[2],a[3]);
+        break;
+    case KT_RWABS_DONE:
+        sprintf(p,"rwabs   rc %ld",a[0]);
+        break;
+    case KT_PEXEC:
+        memcpy(name,&a[1],8);
+        name[8] = '\0';
+        sprintf(p,"pexec   mode %ld %s",a[0],name);
+        break;
+    case KT_PEXEC_LOADED:
+        sprintf(p,"pexec   loaded at %08lx, text %lu",a[0],a[1]);
+        break;
+    case KT_PTERM:
+        sprintf(p,"pterm   %08lx rc %ld",a[0],a[1]);
+        break;
+    case KT_MXALLOC:
+        sprintf(p,"mxalloc %ld mode %lx -> %08lx",a[0],a[1],a[2]);
+        break;
+    case KT_PEXEC_TIMES:
+        sprintf(p,"pexec   %08lx ms: lookup %lu load %lu reloc %lu clear %lu start %lu",a[0],
+                (a[1]>>16)*1000L/hz,(a[1]&0xffff)*1000L/hz,(a[2]>>16)*1000L/hz,
+                (a[2]&0xffff)*1000L/hz,a[3]*1000L/hz);
+        break;
+    default:
+        sprintf(p,"event %u %08lx %08lx %08lx %08lx",e->id,a[0],a[1],a[2],a[3]);
+        break;
+    }
+}
+
+/*
+ *  'mem' subordinate functions
+ */
+
+/*
+ *  display the statistics for one memory pool
+ */
+PRIVATE void mem_report(const char *title,const MSTAT *ms)
+{
+static const char * const sizes[MSTAT_BUCKETS] =
+    { "<1K", "<4K", "<16K", "<64K", "<256K", "<1M", "<4M", ">=4M" };
+const MSTATOWNER *o;
+char buf[80];
+WORD i;
+
+    outputnl(title);
+    show_line(_("  Bytes free:     "),ms->ms_freebytes);
+    show_line(_("  Free blocks:    "),ms->ms_freeblocks);
+    show_line(_("  Largest block:  "),ms->ms_largest);
+    show_line(_("  Bytes used:     "),ms->ms_usedbytes);
+    show_line(_("  Used blocks:    "),ms->ms_usedblocks);
+
+    if (ms->ms_freeblocks)
+        outputnl(_("  Free blocks by size:"));
+    for (i = 0; i < MSTAT_BUCKETS; i++) {
+        if (ms->ms_hist[i] == 0)
+            continue;
+        sprintf(buf,"    %-14s%10ld",sizes[i],ms->ms_hist[i]);
+        outputnl(buf);
+    }
+
+    for (i = 0, o = ms->ms_owner; i < ms->ms_owners; i++, o++) {
+        if (o->o_pd)
+            sprintf(buf,"  %s %08lx:",_("Process"),(ULONG)o->o_pd);
+        else sprintf(buf,"  %s:",_("Others"));
+        sprintf(buf+strlen(buf)," %ld %s, %ld %s",o->o_blocks,_("blocks"),
+                o->o_bytes,_("bytes"));
+        outputnl(buf);
+    }
+}
+
+/*
+ *  'bench' subordinate functions
+ */
+
+/*
+ *  display the result of one benchmark, with the throughput if kbytes > 0
+ */
+PRIVATE void bench_report(const char *title,ULONG ticks,WORD kbytes)
+{
+char buf[80], secs[20];
+
+    format_ticks(secs,ticks);
+    sprintf(buf,"  %-20s %10s s",title,secs);
+    output(buf);
+    if (kbytes > 0) {
+        if (ticks == 0)         /* avoid dividing by zero */
+            ticks = 1;
+        sprintf(buf,"  %6lu KB/s",(ULONG)kbytes*TICKS_PER_SEC/ticks);
+        output(buf);
+    }
+    outputnl("");
+}
+
+/*
+ *  sequential write of a file
+ */
+PRIVATE LONG bench_write(const char *name,char *iobuf,WORD kbytes)
+{
+ULONG start;
+LONG n, len, rc;
+WORD handle;
+
+    start = get_ticks();
+
+    rc = Fcreate(name,0);
+    if (rc < 0L)
+        return rc;
+    handle = LOWORD(rc);
+
+    for (n = (LONG)kbytes * 1024L; n > 0L; n -= len) {
+        len = (n > IOBUFSIZE) ? IOBUFSIZE : n;
+        rc = Fwrite(handle,len,iobuf);
+        if (rc < 0L)
+            break;
+        if (rc != len) {
+            rc = DISK_FULL;
+            break;
+        }
+    }
+    Fclose(handle);
+    if (rc < 0L)
+        return rc;
+
+    bench_report(_("Sequential write"),get_ticks()-start,kbytes);
+
+    return 0L;
+}
+
+/*
+ *  sequential read of a file
+ */
+PRIVATE LONG bench_read(const char *name,char *iobuf)
+{
+ULONG start;
+LONG total = 0L, rc;
+WORD handle;
+
+    start = get_ticks();
+
+    rc = Fopen(name,0);
+    if (rc < 0L)
+        return rc;
+    handle = LOWORD(rc);
+
+    do {
+        rc = Fread(handle,IOBUFSIZE,iobuf);
+        if (rc > 0L)
+            total += rc;
+    } while(rc == IOBUFSIZE);
+    Fclose(handle);
+    if (rc < 0L)
+        return rc;
+
+    bench_report(_("Sequential read"),get_ticks()-start,(WORD)(total/1024));
+
+    return 0L;
+}
+
+/*
+ *  create (delete == 0) or delete (delete != 0) a set of empty files
+ *
+ *  if delete is negative, no report is made and errors are ignored
+ */
+PRIVATE LONG bench_create(char *name,char *p,WORD nfiles,WORD delete)
+{
+ULONG start;
+LONG rc = 0L;
+WORD i;
+
+    start = get_ticks();
+
+    for (i = 0; i < nfiles; i++) {
+        sprintf(p,"BENCH%03d.TMP",i);
+        if (delete) {
+            rc = Fdelete(name);
+        } else {
+            rc = Fcreate(name,0);
+            if (rc >= 0L)
+                rc = Fclose(LOWORD(rc));
+        }
+        if ((rc < 0L) && (delete >= 0))
+            return rc;
+    }
+
+    if (delete >= 0)
+        bench_report(delete ? _("Delete files") : _("Create files"),get_ticks()-start,0);
+
+    return 0L;
+}
+
+/*
+ *  list the files created by bench_create()
+ */
+PRIVATE LONG bench_list(char *name,char *p)
+{
+ULONG start;
+LONG rc;
+
+    start = get_ticks();
+
+    strcpy(p,"BENCH*.TMP");
+    for (rc = dir_first(name,0x07); rc == 0; rc = dir_next())
+        ;
+    if (rc != ENMFIL)
+        return rc;
+
+    bench_report(_("List directory"),get_ticks()-start,0);
+
+    return 0L;
+}
+
+/*
+ *  output BENCH_CONLINES lines of text in various colours to the console
+ *  via the BIOS, then report the number of characters output per second
+ */
+PRIVATE LONG bench_console(void)
+{
+char buf[80], secs[20];
+ULONG start, ticks, chars = 0;
+WORD i, j;
+
+    start = get_ticks();
+
+    for (i = 0; i < BENCH_CONLINES; i++) {
+        if (constat() && user_break())
+            return USER_BREAK;
+        escape('b');                    /* cycle through foreground colours */
+        conout('0'+(i&0x0f));
+        for (j = 0; j < BENCH_CONWIDTH; j++)
+            conout(' '+((i+j)%95));
+        conout('\r');
+        conout('\n');
+        chars += BENCH_CONWIDTH + 2;
+    }
+
+    ticks = get_ticks() - start;
+    escape('b');                        /* restore colours */
+    conout('0'+0x0f);
+    escape('E');                        /* clear screen */
+
+    format_ticks(secs,ticks);
+    sprintf(buf,"  %-20s %10s s",_("Console output"),secs);
+    output(buf);
+    if (ticks == 0)                     /* avoid dividing by zero */
+        ticks = 1;
+    sprintf(buf,"  %6lu chars/s",chars*TICKS_PER_SEC/ticks);
+    outputnl(buf);
+
+    return 0L;
+}
+
 /*
  *  get specified drive's current path (including drive letter) into buffer
  *
@@ -1078,6 +1823,44 @@ WORD i;
     *buf = '\0';
 }
 
+/*
+ *  start a directory search for use with dir_next()
+ */
+PRIVATE LONG dir_first(const char *spec,WORD attr)
+{
+    dirbuf_count = dirbuf_next = 0;
+
+    return Fsfirst(spec,attr);
+}
+
+/*
+ *  like Fsnext(), returning the next entry in the DTA, but fetching
+ *  entries DIRBUF_ENTRIES at a time via Fsnextm() where available
+ */
+PRIVATE LONG dir_next(void)
+{
+LONG rc;
+
+    if (no_fsnextm)
+        return Fsnext();
+
+    if (dirbuf_next >= dirbuf_count) {
+        rc = Fsnextm(dirbuf,(LONG)sizeof(dirbuf));
+        if (rc == EINVFN) {         /* not supported by this GEMDOS */
+            no_fsnextm = TRUE;
+            return Fsnext();
+        }
+        if (rc < 0)
+            return rc;
+        dirbuf_count = rc;
+        dirbuf_next = 0;
+    }
+
+    memcpy(&dta->d_attrib,&dirbuf[dirbuf_next++].d_attrib,sizeof(DIRENTRY)-1);
+
+    return 0L;
+}
+
 PRIVATE void display_dta_detail(void)
 {
 char buf[80], *p = buf;
@@ -14,11 +14,15 @@
  * features:
  *      builtin commands
  *      execution of standard TOS programs
+ *      execution of simple script files (.BAT)
  *      commandline history & editing
  *      output redirection
  *
+ * If EmuCON is started with a command line, it executes it (typically
+ * to run a script file) non-interactively, then exits.
+ *
  * The following omissions are deliberate:
- *      no batch/shell files
+ *      no control flow or variables in script files
  *      no input redirection or pipes
  */
 #include "cmd.h"
@@ -46,6 +50,17 @@ LOCAL char redir_name[MAXPATHLEN];
 LOCAL WORD original_res;
 LOCAL WORD original_color3;
 LOCAL LONG vdo_value;
+LOCAL WORD script_depth;
+
+/*
+ * work area for a script file, allocated by run_script()
+ */
+typedef struct {
+    char line[MAX_LINE_SIZE];   /* current line, after argument expansion */
+    char *argv[MAX_ARGS];
+    char redir[MAXPATHLEN];
+    char text[1];               /* contents of script file, nul-terminated */
+} SCRIPT;
 
 /*
  *  function prototypes
@@ -54,15 +69,18 @@ PRIVATE void change_res(WORD res);
 PRIVATE void close_redir(void);
 PRIVATE void create_redir(const char *name);
 PRIVATE WORD execute(WORD argc,char **argv,char *redir);
+PRIVATE WORD expand_script_line(char *out,const char *in,WORD argc,char **argv);
 PRIVATE WORD get_nflops(void);
+PRIVATE void run_cmdtail(void);
 PRIVATE void strip_quotes(int argc,char **argv);
+PRIVATE WORD time_command(WORD argc,char **argv,char *redir);
 PRIVATE void getenv(char **ppath, const char *psrch);
 
 int cmdmain(void);      /* called only from cmdasm.S */
 
 int cmdmain(void)
 {
-WORD argc, rc;
+WORD argc, rc, batch;
 
     /*
      *  initialise some global variables
@@ -82,25 +100,30 @@ WORD argc, rc;
 
     nflops_copy = Supexec(get_nflops);      /* number of floppy drives */
 
-    /*
-     * start up in ST medium if we are currently in ST low
-     */
-    if (current_res == ST_LOW)
-        change_res(ST_MEDIUM);
+    batch = (cmdtail[0] != 0);              /* started with a command line */
 
-    /* clear_screen(); */
-    enable_cursor();
-    message(_("Welcome to EmuCON2 version ")); messagenl(version);
-    messagenl(_("Type HELP for builtin commands"));
-    messagenl("");
+    if (!batch) {
+        /*
+         * start up in ST medium if we are currently in ST low
+         */
+        if (current_res == ST_LOW)
+            change_res(ST_MEDIUM);
+
+        /* clear_screen(); */
+        enable_cursor();
+        message(_("Welcome to EmuCON2 version ")); messagenl(version);
+        messagenl(_("Type HELP for builtin commands"));
+        messagenl("");
+    }
 
     linewrap = 0;
     dta = (DTA *)Fgetdta();
     redir_name[0] = '\0';
     redir_handle = -1L;
 
-    if (init_cmdedit() < 0)
-        messagenl(_("warning: no history buffers"));
+    if (!batch)
+        if (init_cmdedit() < 0)
+            messagenl(_("warning: no history buffers"));
 
     {
         /* Setup path from the PATH environment variable */
@@ -117,6 +140,12 @@ WORD argc, rc;
         }
     }
 
+    if (batch) {
+        init_screen();
+        run_cmdtail();
+        return 0;
+    }
+
     while(1) {
         init_screen();      /* init variables for screen size */
 
@@ -160,6 +189,9 @@ LONG rc;
     if (func == LOOKUP_EXIT)    /* exit/quit */
         return -1;
 
+    if (func == LOOKUP_TIME)    /* time <cmd> */
+        return time_command(argc-1,argv+1,redir);
+
     if (func == LOOKUP_ARGS)
         rc = WRONG_NUM_ARGS;
     else if (func) {
@@ -177,6 +209,196 @@ LONG rc;
     return 0;
 }
 
+/*
+ * execute the command line that EmuCON was started with
+ */
+PRIVATE void run_cmdtail(void)
+{
+WORD argc, len;
+
+    len = (UBYTE)cmdtail[0];
+    if (len > MAXCMDLINE)
+        len = MAXCMDLINE;
+    memcpy(input_line,cmdtail+1,len);
+    input_line[len] = '\0';
+
+    argc = parse_line(input_line,arglist,redir_name);
+    if (argc > 0)
+        execute(argc,arglist,redir_name);
+}
+
+/*
+ * execute a script file
+ *
+ * each line is executed as if it had been typed at the command line,
+ * except that:
+ *  . empty lines, and lines starting with '#' or 'rem', are ignored
+ *  . a leading '@' is ignored, for compatibility with DOS batch files
+ *  . %0 to %9 are replaced by the script name & arguments, %% by %
+ *  . 'exit' terminates the script, not EmuCON
+ *  . resolution changes via the 'mode' command are ignored
+ * control-C interrupts the script between lines.
+ *
+ * returns an error code, for errmsg()
+ */
+LONG run_script(const char *path,WORD argc,char **argv)
+{
+SCRIPT *script = NULL;
+char *p, *next;
+LONG len, rc;
+WORD handle, n;
+
+    if (script_depth >= MAX_SCRIPT_DEPTH)
+        return SCRIPT_DEPTH;
+
+    /*
+     * read the whole script into memory
+     */
+    rc = Fopen(path,0);
+    if (rc < 0L)
+        return rc;
+    handle = LOWORD(rc);
+
+    rc = len = Fseek(0L,handle,2);
+    if (rc >= 0L)
+        rc = Fseek(0L,handle,0);
+    if (rc >= 0L) {
+        script = (SCRIPT *)Malloc(sizeof(SCRIPT)+len);
+        if (!script)
+            rc = ENSMEM;
+    }
+    if (rc >= 0L) {
+        rc = Fread(handle,len,script->text);
+        if (rc >= 0L)
+            script->text[rc] = '\0';
+    }
+    Fclose(handle);
+
+    if (rc < 0L) {
+        if (script)
+            Mfree(script);
+        return rc;
+    }
+
+    /*
+     * then execute it line by line
+     */
+    script_depth++;
+    for (p = script->text, rc = 0L; *p; p = next) {
+        for (next = p; *next && (*next != '\n'); next++)
+            ;
+        if (*next)
+            *next++ = '\0';
+
+        if (constat()) {
+            if (LOBYTE(conin()) == CTL_C) {
+                rc = USER_BREAK;
+                break;
+            }
+        }
+
+        if (expand_script_line(script->line,p,argc,argv) < 0) {
+            rc = CMDLINE_LENGTH;
+            break;
+        }
+        script->redir[0] = '\0';
+        n = parse_line(script->line,script->argv,script->redir);
+        if (n <= 0)             /* nothing to do, or error already reported */
+            continue;
+        if (execute(n,script->argv,script->redir) < 0)  /* exit */
+            break;
+    }
+    script_depth--;
+
+    Mfree(script);
+
+    return rc;
+}
+
+/*
+ * prepare a line from a script file for parsing (see run_script())
+ *
+ * returns -1 iff the expanded line is too long
+ */
+PRIVATE WORD expand_script_line(char *out,const char *in,WORD argc,char **argv)
+{
+char *end = out + MAX_LINE_SIZE - 1;
+const char *arg;
+WORD n;
+
+    while((*in == ' ') || (*in == '\t'))
+        in++;
+    if (*in == '@')
+        in++;
+
+    if ((*in == '#')
+     || ((strncasecmp(in,"rem",3) == 0) && ((in[3] == ' ') || (in[3] == '\t') || (in[3] == '\r') || !in[3])))
+        in = "";
+
+    for ( ; *in && (*in != '\r'); in++) {
+        if ((*in == '%') && (in[1] == '%')) {
+            in++;
+        } else if ((*in == '%') && (in[1] >= '0') && (in[1] <= '9')) {
+            n = *++in - '0';
+            for (arg = (n < argc) ? argv[n] : ""; *arg; )
+                if (out < end)
+                    *out++ = *arg++;
+                else return -1;
+            continue;
+        }
+        if (out >= end)
+            return -1;
+        *out++ = *in;
+    }
+    *out = '\0';
+
+    return 0;
+}
+
+/*
+ * execute a command, then display the elapsed time and, if available,
+ * the amount of I/O done via GEMDOS and the BIOS
+ *
+ * returns: as for execute()
+ */
+PRIVATE WORD time_command(WORD argc,char **argv,char *redir)
+{
+IOSTATS before, after;
+IDLESTATS idle_before, idle_after;
+ULONG start, ticks;
+WORD have_stats, have_idle, rc;
+char buf[80], secs[20];
+
+    have_stats = get_iostats(&before);
+    have_idle = get_idlestats(&idle_before);
+    start = get_ticks();
+
+    rc = execute(argc,argv,redir);
+
+    ticks = get_ticks() - start;
+    format_ticks(secs,ticks);
+    sprintf(buf,_("elapsed: %s s (%lu ticks)"),secs,ticks);
+    messagenl(buf);
+
+    if (have_stats && get_iostats(&after)) {
+        sprintf(buf,_("read:    %10lu bytes %8lu sectors"),
+                after.bytes_read-before.bytes_read,after.sectors_read-before.sectors_read);
+        messagenl(buf);
+        sprintf(buf,_("written: %10lu bytes %8lu sectors"),
+                after.bytes_written-before.bytes_written,after.sectors_written-before.sectors_written);
+        messagenl(buf);
+    }
+
+    if (have_idle && get_idlestats(&idle_after) && ticks) {
+        sprintf(buf,_("idle:    %10lu ticks (%lu%%)"),
+                idle_after.idle_ticks-idle_before.idle_ticks,
+                (idle_after.idle_ticks-idle_before.idle_ticks)*100/ticks);
+        messagenl(buf);
+    }
+
+    return rc;
+}
+
 PRIVATE void create_redir(const char *name)
 {
 LONG rc;
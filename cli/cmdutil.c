@@ -97,6 +97,9 @@ const char *p;
     case CANT_DELETE:
         p = _("can't delete file (read-only?)");
         break;
+    case SCRIPT_DEPTH:
+        p = _("scripts nested too deeply");
+        break;
     case INVALID_PARAM:
         p = _("invalid parameter");
         break;
@@ -266,7 +269,7 @@ const char *p;
 }
 
 /*
- *  return pointer to file extension iff a program
+ *  return pointer to file extension iff a program or a script
  */
 const char *program_extension(const DTA *dtaptr)
 {
@@ -278,7 +281,7 @@ const char *p;
     for (p = dtaptr->d_fname; *p; ) {
         if (*p++ == '.') {
             if (strequal(p,"app") || strequal(p,"gtp") || strequal(p,"prg")
-             || strequal(p,"tos") || strequal(p,"ttp"))
+             || strequal(p,"tos") || strequal(p,"ttp") || strequal(p,"bat"))
                 return p;
         }
     }
@@ -339,6 +342,76 @@ COOKIE *jar, *c;
     return 0;
 }
 
+/*
+ *  get_iostats() - take a snapshot of the EmuTOS I/O counters
+ *
+ *  returns 0 if they are not available
+ */
+WORD get_iostats(IOSTATS *stats)
+{
+LONG value;
+
+    if (getcookie(EIOS_COOKIE,&value) == 0)
+        return 0;
+
+    memcpy(stats,(IOSTATS *)value,sizeof(IOSTATS));
+
+    return 1;
+}
+
+/*
+ *  get_idlestats() - take a snapshot of the EmuTOS idle counters
+ *
+ *  returns 0 if they are not available
+ */
+WORD get_idlestats(IDLESTATS *stats)
+{
+LONG value;
+
+    if (getcookie(EIDL_COOKIE,&value) == 0)
+        return 0;
+
+    memcpy(stats,(IDLESTATS *)value,sizeof(IDLESTATS));
+
+    return 1;
+}
+
+/*
+ *  get_ktrace() - get a pointer to the EmuTOS kernel trace
+ *
+ *  returns NULL if it is not available
+ */
+KTRACE *get_ktrace(void)
+{
+LONG value;
+
+    if (getcookie(EKTR_COOKIE,&value) == 0)
+        return NULL;
+
+    return (KTRACE *)value;
+}
+
+PRIVATE LONG gethz200(void)
+{
+    return *(volatile LONG *)0x4ba;
+}
+
+/*
+ *  get_ticks() - return current value of 200Hz system timer
+ */
+ULONG get_ticks(void)
+{
+    return Supexec(gethz200);
+}
+
+/*
+ *  format_ticks() - convert a number of ticks to a string in seconds
+ */
+void format_ticks(char *buf,ULONG ticks)
+{
+    sprintf(buf,"%lu.%03lu",ticks/TICKS_PER_SEC,(ticks%TICKS_PER_SEC)*(1000L/TICKS_PER_SEC));
+}
+
 #ifdef STANDALONE_CONSOLE
 
 /* Avoid bug: libc function implementation is optimized as a call to itself.
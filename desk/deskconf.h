@@ -43,4 +43,11 @@
  */
 #define MAX_LEVEL   12              /* max number of directory levels */
 
+/*
+ * number of spare FNODEs allocated with each directory window's list.
+ * they allow the desktop to add files & folders that it has created to
+ * the list without re-reading the directory (see pn_update()).
+ */
+#define SPARE_FNODES 16
+
 #endif  /* _DESKCONF_H */
@@ -848,6 +848,39 @@ static BOOL source_is_parent(char *src, char *dst)
 }
 
 
+/*
+ *  Update any windows displaying the folder containing the file or
+ *  folder 'path' (which may end in "\*.*" for a folder)
+ */
+static void update_windows(char *path)
+{
+    char item[MAXPATHLEN];
+    char *p;
+
+    strcpy(item, path);
+    p = filename_start(item);
+    if (*p == '*')
+        p[-1] = '\0';
+
+    pn_update(item);
+}
+
+
+/*
+ *  Check if two paths are in the same folder
+ */
+static BOOL same_folder(char *path1, char *path2)
+{
+    WORD len;
+
+    len = filename_start(path1) - path1;
+    if (filename_start(path2) - path2 != len)
+        return FALSE;
+
+    return strncmp(path1, path2, len) == 0;
+}
+
+
 /*
  *  DIRectory routine that does an OPeration on all the selected files and
  *  folders in the source path.  The selected files and folders are
@@ -858,6 +891,7 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
     OBJECT *tree, *obj;
     FNODE *pf;
     WORD more, confirm;
+    BOOL patch;
     char *ptmpsrc, *ptmpdst, *psrc_path = pspath->p_spec;
     LONG lavail;
     char srcpth[MAXPATHLEN], dstpth[MAXPATHLEN];
@@ -960,6 +994,27 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
         desk_busy_on();
     }
 
+    /*
+     * the lists of windows displaying the source and destination folders
+     * are updated item by item, so that they need not be rebuilt from
+     * the directory.  if both folders are the same (copying with a new
+     * name), we let the windows be rebuilt instead.
+     */
+    switch(op)
+    {
+    case OP_DELETE:
+        patch = TRUE;
+        break;
+    case OP_COPY:
+    case OP_MOVE:
+    case OP_RENAME:
+        patch = !same_folder(psrc_path, pdst_path);
+        break;
+    default:
+        patch = FALSE;
+        break;
+    }
+
     for (pf = pspath->p_flist; pf && more; pf = pf->f_next)
     {
         if (!fnode_is_selected(pf))
@@ -999,6 +1054,13 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
                     more = (op==OP_RENAME) ? d_dofoldren(srcpth,dstpth) :
                             d_doop(0, op, srcpth, dstpth, tree, count);
             }
+            if (patch)
+            {
+                if (op != OP_COPY)
+                    update_windows(srcpth);
+                if (op != OP_DELETE)
+                    update_windows(dstpth);
+            }
             if (!more)
                 break;
             continue;
@@ -1024,12 +1086,16 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
             ptmpdst = add_fname(dstpth, pf->f_name);
             more = (op==OP_RENAME) ? d_dofileren(srcpth,dstpth,FALSE) :
                     d_dofcopy(srcpth, dstpth, pf->f_time, pf->f_date, pf->f_attr);
+            if (patch)
+                update_windows(dstpth);
             set_all_files(ptmpdst); /* restore original dest path */
             /* if moving, delete original only if copy was ok */
             if ((op == OP_MOVE) && (more > 0))
                 more = d_dofdel(srcpth);
             break;
         }
+        if (patch && (op != OP_COPY))
+            update_windows(srcpth);
         if (op != OP_COUNT)
             set_all_files(ptmpsrc); /* restore original source path */
 
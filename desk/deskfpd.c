@@ -4,7 +4,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2021 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -47,7 +47,7 @@ static void fl_free(PNODE *pn)
     if (pn->p_fbase)
         dos_free(pn->p_fbase);
 
-    pn->p_fbase = pn->p_flist = NULL;
+    pn->p_fbase = pn->p_flist = pn->p_ffree = NULL;
     pn->p_count = 0;
     pn->p_size = 0L;
 }
@@ -82,6 +82,7 @@ PNODE *pn_open(char *pathname, WNODE *pw)
 
     thepath = &pw->w_pnode;
     thepath->p_flist = NULL;    /* file list starts empty */
+    thepath->p_ffree = NULL;
     strcpy(thepath->p_spec,pathname);
     thepath->p_attr = DISPATTR;
 
@@ -128,11 +129,67 @@ static LONG pn_fcomp(FNODE *pf1, FNODE *pf2, WORD which)
 }
 
 
+/*
+ *  Return the first 4 characters of a string packed into a ULONG, which
+ *  compares in the same way as the string itself (note that strcmp()
+ *  compares unsigned characters)
+ */
+static ULONG str_key(const char *s)
+{
+    ULONG key = 0L;
+    WORD i;
+
+    for (i = 0; i < 4; i++)
+    {
+        key <<= 8;
+        if (*s)
+            key |= (UBYTE)*s++;
+    }
+
+    return key;
+}
+
+
+/*
+ *  Set the primary sort key of a file node, based on G.g_isort.
+ *
+ *  If the keys of two fnodes differ, they compare in the same way as
+ *  pn_fcomp() would; otherwise pn_fcomp() must be used.
+ */
+static void pn_setkey(FNODE *pf)
+{
+    ULONG key;
+
+    switch(G.g_isort)
+    {
+    case S_DATE:            /* newest first */
+        key = ~(((ULONG)pf->f_date << 16) | pf->f_time);
+        break;
+    case S_SIZE:            /* largest first */
+        key = ~(ULONG)pf->f_size;
+        break;
+    case S_TYPE:
+        key = str_key(scasb(pf->f_name,'.'));
+        break;
+    case S_NSRT:
+        key = pf->f_seq;
+        break;
+    default:                /* S_NAME */
+        key = str_key(pf->f_name);
+        break;
+    }
+
+    pf->f_key = key;
+}
+
+
 /*
  *  Routine to compare two fnodes to see which one is greater.
  *  Sort sequence is based on the G.g_isort parameter; folders
  *  always sort out first (unless 'unsorted' is specified).
  *
+ *  The sort keys must have been set by pn_setkey().
+ *
  *  Returns -ve if pf1 < pf2, 0 if pf1 == pf2, and +ve if pf1 > pf2
  */
 static LONG pn_comp(FNODE *pf1, FNODE *pf2)
@@ -143,66 +200,84 @@ static LONG pn_comp(FNODE *pf1, FNODE *pf2)
             return (pf1->f_attr & FA_SUBDIR) ? -1L : 1L;
     }
 
+    if (pf1->f_key != pf2->f_key)
+        return (pf1->f_key < pf2->f_key) ? -1L : 1L;
+
     return pn_fcomp(pf1,pf2,G.g_isort);
 }
 
 
+/*
+ *  Merge two sorted lists of fnodes; for equal fnodes, those in
+ *  list 'p' sort first
+ */
+static FNODE *pn_merge(FNODE *p, FNODE *q)
+{
+    FNODE *list, **pnext = &list;
+
+    while(p && q)
+    {
+        if (pn_comp(p, q) <= 0L)
+        {
+            *pnext = p;
+            pnext = &p->f_next;
+            p = p->f_next;
+        }
+        else
+        {
+            *pnext = q;
+            pnext = &q->f_next;
+            q = q->f_next;
+        }
+    }
+    *pnext = p ? p : q;
+
+    return list;
+}
+
+
 /*
  *  Sort the fnodes in the list chained from the specified pathnode
  *
+ *  This is a bottom-up merge sort: bin[i] holds a sorted list of 2^i
+ *  fnodes (or is empty).  Each fnode is merged into the bins like
+ *  a carry propagating through a binary counter.
  */
+#define SORT_BINS   16          /* enough for 64K fnodes */
+
 FNODE *pn_sort(PNODE *pn)
 {
-    FNODE *pf, *pftemp;
-    FNODE *newlist;
-    FNODE **ml_pfndx;
-    WORD  count, gap, i, j;
+    FNODE *pf, *carry, *list;
+    FNODE *bin[SORT_BINS];
+    WORD  i;
 
-    if (pn->p_count < 2)        /* the list is already sorted */
-        return pn->p_flist;
+    for (pf = pn->p_flist; pf; pf = pf->f_next)
+        pn_setkey(pf);
 
-    /*
-     * malloc & build index array
-     */
-    ml_pfndx = dos_alloc_anyram(pn->p_count*sizeof(FNODE *));
-    if (!ml_pfndx)              /* no space, can't sort */
-    {
-        malloc_fail_alert();
+    if (pn->p_count < 2)        /* the list is already sorted */
         return pn->p_flist;
-    }
 
-    for (count = 0, pf = pn->p_flist; pf; pf = pf->f_next)
-        ml_pfndx[count++] = pf;
+    for (i = 0; i < SORT_BINS; i++)
+        bin[i] = NULL;
 
-    /* sort files using shell sort on page 108 of  K&R C Prog. Lang. */
-    for (gap = count/2; gap > 0; gap /= 2)
+    for (pf = pn->p_flist; pf; )
     {
-        for (i = gap; i < count; i++)
+        carry = pf;
+        pf = pf->f_next;
+        carry->f_next = NULL;
+        for (i = 0; (i < SORT_BINS-1) && bin[i]; i++)
         {
-            for (j = i-gap; j >= 0; j -= gap)
-            {
-                if (pn_comp(ml_pfndx[j], ml_pfndx[j+gap]) <= 0L)
-                    break;
-                pftemp = ml_pfndx[j];
-                ml_pfndx[j] = ml_pfndx[j+gap];
-                ml_pfndx[j+gap] = pftemp;
-            }
+            carry = pn_merge(bin[i], carry);
+            bin[i] = NULL;
         }
+        bin[i] = pn_merge(bin[i], carry);
     }
 
-    /* link up the list in order */
-    newlist = ml_pfndx[0];
-    pf = ml_pfndx[0];
-    for (i = 1; i < count; i++)
-    {
-        pf->f_next = ml_pfndx[i];
-        pf = ml_pfndx[i];
-    }
-    pf->f_next = (FNODE *) NULL;
+    /* the lower bins hold the later fnodes */
+    for (i = 0, list = NULL; i < SORT_BINS; i++)
+        list = pn_merge(bin[i], list);
 
-    dos_free(ml_pfndx);
-
-    return newlist;
+    return list;
 }
 
 
@@ -221,7 +296,7 @@ FNODE *pn_sort(PNODE *pn)
  *              NOTE: if insufficient memory is available, some files in
  *              the specified pathnode will be silently excluded from the
  *              filenode list.  our excuse is that Atari TOS does this too ...
- *          <0  error (other than EFILNF/ENMFIL) returned by dos_sfirst()/dos_snext()
+ *          <0  error (other than EFILNF/ENMFIL) returned by dos_sfirst_bulk()/dos_snext_bulk()
  *              (e.g. when attempting to open a floppy drive with no disk)
  */
 WORD pn_active(PNODE *pn, BOOL include_folders)
@@ -229,7 +304,7 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
     DTA *dtasave;
     FNODE *fn, *prev;
     LONG maxmem, maxcount, size = 0L;
-    WORD count, ret;
+    WORD count, spare, ret;
 #if CONF_WITH_FILEMASK
     char search[MAXPATHLEN];
     char *match;
@@ -256,13 +331,13 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
     if (include_folders)                /* match all folders? */
         del_fname(search);              /* yes - change search filespec to *.* */
     match = filename_start(pn->p_spec); /* the match filespec is always unaltered */
-    for (ret = dos_sfirst(search, pn->p_attr), count = 0; (ret == 0) && (count < maxcount); ret = dos_snext())
+    for (ret = dos_sfirst_bulk(search, pn->p_attr), count = 0; (ret == 0) && (count < maxcount); ret = dos_snext_bulk())
     {
         if (G.g_wdta.d_attrib != FA_SUBDIR) /* skip *files* that don't match */
             if (!wildcmp(match, G.g_wdta.d_fname))
                 continue;
 #else
-    for (ret = dos_sfirst(pn->p_spec,pn->p_attr), count = 0; (ret == 0) && (count < maxcount); ret = dos_snext())
+    for (ret = dos_sfirst_bulk(pn->p_spec,pn->p_attr), count = 0; (ret == 0) && (count < maxcount); ret = dos_snext_bulk())
     {
 #endif
         if (G.g_wdta.d_fname[0] == '.') /* skip "." & ".." entries */
@@ -278,13 +353,21 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
     pn->p_count = count;        /* & update pathnode */
     pn->p_size = size;
 
-    if (count == 0)
+    /* keep some spare fnodes for pn_update() */
+    spare = (maxcount - count < SPARE_FNODES) ? maxcount - count : SPARE_FNODES;
+
+    if (count + spare == 0)
     {
         fl_free(pn);            /* free any existing filenodes */
     }
     else
     {
-        dos_shrink(pn->p_fbase,count*sizeof(FNODE));
+        dos_shrink(pn->p_fbase,(count+spare)*sizeof(FNODE));
+        for ( ; spare; spare--, fn++)
+        {
+            fn->f_next = pn->p_ffree;
+            pn->p_ffree = fn;
+        }
         pn->p_flist = pn_sort(pn);
     }
 
@@ -298,6 +381,154 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
 }
 
 
+/*
+ *  Remove the file node with the specified name (if any) from a list
+ *
+ *  Note: the fnode itself is not reused until the list is rebuilt, so
+ *  that a caller walking the list is not affected
+ */
+static void pn_delfile(PNODE *pn, char *name)
+{
+    FNODE *pf, *prev;
+
+    prev = (FNODE *)&pn->p_flist;   /* assumes fnode link is at start of fnode */
+    for (pf = pn->p_flist; pf; prev = pf, pf = pf->f_next)
+    {
+        if (strcmp(pf->f_name, name) == 0)
+        {
+            prev->f_next = pf->f_next;
+            pn->p_count--;
+            pn->p_size -= pf->f_size;
+            break;
+        }
+    }
+}
+
+
+/*
+ *  Add a file node for the file or folder described by the DTA to a
+ *  list, in sort sequence, replacing any existing fnode with that name
+ *
+ *  Returns FALSE if the list cannot be updated
+ */
+static BOOL pn_addfile(PNODE *pn, DTA *dta)
+{
+    FNODE *fn, *pf, *prev;
+    char *match;
+
+    if (dta->d_fname[0] == '.')     /* "." & ".." are never listed */
+        return TRUE;
+
+    match = filename_start(pn->p_spec);
+#if CONF_WITH_FILEMASK
+    if (dta->d_attrib != FA_SUBDIR)
+#endif
+        if (!wildcmp(match, dta->d_fname))
+            return TRUE;
+
+    /*
+     * in directory sequence, we don't know where a new entry goes
+     */
+    if (G.g_isort == S_NSRT)
+        return FALSE;
+
+    for (pf = pn->p_flist; pf; pf = pf->f_next)
+    {
+        if (strcmp(pf->f_name, dta->d_fname) == 0)
+        {
+            if (memcmp(&pf->f_attr, &dta->d_attrib, 23) == 0)
+                return TRUE;        /* unchanged */
+            pn_delfile(pn, dta->d_fname);
+            break;
+        }
+    }
+
+    fn = pn->p_ffree;
+    if (!fn)
+        return FALSE;
+    pn->p_ffree = fn->f_next;
+
+    fn->f_selected = FALSE;
+    memcpy(&fn->f_attr, &dta->d_attrib, 23);
+    fn->f_seq = pn->p_count;
+    pn_setkey(fn);
+
+    prev = (FNODE *)&pn->p_flist;
+    for (pf = pn->p_flist; pf; prev = pf, pf = pf->f_next)
+        if (pn_comp(fn, pf) < 0L)
+            break;
+    fn->f_next = pf;
+    prev->f_next = fn;
+
+    pn->p_count++;
+    pn->p_size += fn->f_size;
+
+    return TRUE;
+}
+
+
+/*
+ *  Update the file lists of the windows displaying the folder that
+ *  contains 'path', after the desktop has created, changed or deleted
+ *  the file or folder 'path'.
+ *
+ *  Windows whose lists have been updated are marked WN_PATCHED, so that
+ *  the following rebuild does not need to re-read the directory; those
+ *  that cannot be updated are marked WN_STALE.
+ */
+void pn_update(char *path)
+{
+    WNODE *pw;
+    DTA dta, *dtasave;
+    char *name;
+    WORD len, ret;
+    BOOL ok;
+
+    name = filename_start(path);
+    len = name - path;
+
+    dtasave = dos_gdta();
+    dos_sdta(&dta);
+    ret = dos_sfirst(path, DISPATTR);
+    dos_sdta(dtasave);
+
+    for (pw = G.g_wfirst; pw; pw = pw->w_next)
+    {
+        if (!pw->w_id)
+            continue;
+        if ((filename_start(pw->w_pnode.p_spec) - pw->w_pnode.p_spec != len)
+         || (strncmp(pw->w_pnode.p_spec, path, len) != 0))
+            continue;
+
+        if (ret == 0)
+            ok = pn_addfile(&pw->w_pnode, &dta);
+        else if (ret == EFILNF)
+        {
+            pn_delfile(&pw->w_pnode, name);
+            ok = TRUE;
+        }
+        else ok = FALSE;
+
+        pw->w_flags |= ok ? WN_PATCHED : WN_STALE;
+    }
+}
+
+
+/*
+ *  Forget which windows were updated by pn_update()
+ *
+ *  This is called after each desktop event has been handled, so that
+ *  any later rebuild re-reads the directory again
+ */
+void pn_update_done(void)
+{
+    WNODE *pw;
+
+    for (pw = G.g_wfirst; pw; pw = pw->w_next)
+        pw->w_flags &= ~(WN_PATCHED|WN_STALE);
+}
+
+
 /*
  *  Clear the selection flag in all FNODES chained from the PNODE in the specified WNODE
  */
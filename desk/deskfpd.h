@@ -2,7 +2,7 @@
 /*      for 3.0         11/4/87                 mdf             */
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2021 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -60,6 +60,7 @@ struct _filenode
     LONG  f_size;               /*    corresponding items in   */
     char  f_name[LEN_ZFNAME];   /*     the DTA structure!      */
     WORD  f_seq;            /* sequence within directory */
+    ULONG f_key;            /* primary sort key, set by pn_sort() */
     WORD  f_obid;           /* index into G.g_screen[] for this object */
     ANODE *f_pa;            /* ANODE to get icon# from */
     BOOL  f_isap;           /* if TRUE, use a_aicon in ANODE, else use a_dicon */
@@ -73,6 +74,7 @@ struct _pathnode
     char  p_spec[LEN_ZPATH];/* dir path containing the FNODEs below */
     FNODE *p_fbase;         /* start of malloc'd fnodes */
     FNODE *p_flist;         /* linked list of fnodes */
+    FNODE *p_ffree;         /* spare fnodes, used by pn_update() */
     WORD  p_count;          /* number of items (fnodes) */
     LONG  p_size;           /* total size of items */
 };
@@ -88,6 +90,8 @@ PNODE *pn_open(char *pathname, WNODE *pw);
 FNODE *pn_sort(PNODE *pn);
 WORD pn_active(PNODE *thepath, BOOL include_folders);
 FNODE *pn_selected(WNODE *pw);
+void pn_update(char *path);
+void pn_update_done(void);
 void pn_count(WNODE *pw, WORD *nsel, WORD *napp);
 
 #endif  /* _DESKFPD_H */
@@ -136,7 +136,10 @@ static void rebuild_window(WNODE *pwin)
 {
     GRECT gr;
 
-    pn_active(&pwin->w_pnode, TRUE);
+    /* no need to re-read the directory if pn_update() did the work */
+    if ((pwin->w_flags & (WN_PATCHED|WN_STALE)) != WN_PATCHED)
+        pn_active(&pwin->w_pnode, TRUE);
+    pwin->w_flags &= ~(WN_PATCHED|WN_STALE);
     desk_verify(pwin->w_id, TRUE);
     win_sinfo(pwin, FALSE);
     wind_get_grect(pwin->w_id, WF_WXYWH, &gr);
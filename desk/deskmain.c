@@ -2120,6 +2120,9 @@ BOOL deskmain(void)
 
         /* free the screen      */
         wind_update(END_UPDATE);
+
+        /* window lists updated in place are only valid for this event */
+        pn_update_done();
     }
 
     /*
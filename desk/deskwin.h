@@ -48,6 +48,8 @@
  * flags in w_flags below
  */
 #define WN_DESKTOP      0x0001              /* the desktop pseudo-window */
+#define WN_PATCHED      0x0002              /* FNODE list updated by pn_update() */
+#define WN_STALE        0x0004              /* pn_update() could not update list */
 #define WN_REBUILD      0x8000              /* this window needs rebuilding */
 
 
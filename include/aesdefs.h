@@ -549,6 +549,7 @@ typedef struct mform
 #define WF_SCREEN   17
 #define WF_COLOR    18
 #define WF_DCOLOR   19
+#define WF_XRLIST   0x4552  /* EmuTOS extension: get the whole rectangle list */
 
 /* request type: wind_calc() */
 #define WC_BORDER   0
@@ -54,6 +54,20 @@ typedef struct
     char    d_fname[14];        /* name */
 } DTA;
 
+/*
+ * Directory entry returned by Fsnextm() (EmuTOS extension).  Apart from
+ * d_resvd, the layout is the same as the end of the DTA.
+ */
+typedef struct
+{
+    char    d_resvd;            /* keeps the following fields aligned */
+    char    d_attrib;           /* attributes */
+    UWORD   d_time;             /* packed time */
+    UWORD   d_date;             /* packed date */
+    LONG    d_length;           /* size */
+    char    d_fname[14];        /* name */
+} DIRENTRY;
+
 /*
  *  PD - Process Descriptor (a.k.a. BASEPAGE)
  */
@@ -96,6 +110,38 @@ struct _pd
     char    p_cmdlin[PDCLSIZE];     /* command line image */
 };
 
+/*
+ *  MSTAT - memory pool statistics returned by Mstat() (EmuTOS extension)
+ */
+#define MSTAT_ST        0   /* values for the 'pool' argument of Mstat() */
+#define MSTAT_ALT       1
+
+#define MSTAT_BUCKETS   8   /* free block sizes <1K, <4K, <16K, ... , >=4M */
+#define MSTAT_OWNERS    8   /* size of ms_owner[] */
+
+typedef struct
+{
+    PD      *o_pd;          /* owner, NULL for all owners that didn't fit */
+    LONG    o_blocks;       /* number of blocks owned */
+    LONG    o_bytes;        /* total size of the blocks */
+} MSTATOWNER;
+
+typedef struct
+{
+    LONG    ms_freeblocks;  /* number of free blocks */
+    LONG    ms_freebytes;   /* total size of the free blocks */
+    LONG    ms_largest;     /* size of the largest free block */
+    LONG    ms_usedblocks;  /* number of allocated blocks */
+    LONG    ms_usedbytes;   /* total size of the allocated blocks */
+    LONG    ms_hist[MSTAT_BUCKETS]; /* number of free blocks, by size */
+    WORD    ms_owners;      /* number of entries used in ms_owner[] */
+    MSTATOWNER ms_owner[MSTAT_OWNERS];
+                            /* OS internal pool, the same for all pools: */
+    LONG    ms_osmtotal;    /* number of 64-byte blocks */
+    LONG    ms_osmused;     /* number of blocks in use */
+    LONG    ms_osmfails;    /* number of times no block was available */
+} MSTAT;
+
 /* p_flags values: */
 #define PF_FASTLOAD     0x0001
 #define PF_TTRAMLOAD    0x0002
@@ -58,6 +58,11 @@ WORD cache_exists(void);
 void set_cache(WORD enable);
 #endif
 
+#if CONF_WITH_BLOCK_CONOUT
+/* output a run of printable characters to the console, see bios.c */
+LONG bconws(WORD handle, const char *buf, LONG count);
+#endif
+
 /* bios allocation of ST-RAM */
 UBYTE *balloc_stram(ULONG size, BOOL top);
 
@@ -79,6 +84,39 @@ void flop_eject(void);
 extern void (*mousexvec)(WORD scancode);    /* Additional mouse buttons */
 #endif
 
+#if CONF_WITH_IO_STATS
+/*
+ * I/O statistics, pointed to by the EIOS cookie.  The counters are never
+ * reset; users should compute the difference between two snapshots.
+ */
+typedef struct {
+    ULONG bytes_read;           /* by Fread() on files */
+    ULONG bytes_written;        /* by Fwrite() on files */
+    ULONG sectors_read;         /* physical sectors, by Rwabs() */
+    ULONG sectors_written;      /* physical sectors, by Rwabs() */
+} IOSTATS;
+
+extern IOSTATS iostats;
+#endif
+
+/* wait for an interrupt while idle */
+void idle_wait(void);
+
+#if CONF_WITH_IDLE_STATS
+/*
+ * Idle statistics, pointed to by the EIDL cookie.  Like the I/O
+ * statistics, the counters are never reset; the idle percentage over
+ * an interval is the increase in idle_ticks divided by the increase
+ * in _hz_200.
+ */
+typedef struct {
+    ULONG idle_ticks;           /* 200 Hz ticks spent in idle_wait() */
+    ULONG idle_waits;           /* number of calls to idle_wait() */
+} IDLESTATS;
+
+extern IDLESTATS idlestats;
+#endif
+
 /* Line A extensions */
 extern UBYTE v_planes_shift; /* pixel to address helper */
 
@@ -349,6 +349,42 @@
 # ifndef CONF_WITH_BIOS_EXTENSIONS
 #  define CONF_WITH_BIOS_EXTENSIONS 0
 # endif
+# ifndef CONF_WITH_IO_STATS
+#  define CONF_WITH_IO_STATS 0
+# endif
+# ifndef CONF_WITH_IDLE_STATS
+#  define CONF_WITH_IDLE_STATS 0
+# endif
+# ifndef CONF_WITH_MEMORY_STATS
+#  define CONF_WITH_MEMORY_STATS 0
+# endif
+# ifndef CONF_WITH_BLOCK_CONOUT
+#  define CONF_WITH_BLOCK_CONOUT 0
+# endif
+# ifndef CONF_WITH_FAST_LINE_INPUT
+#  define CONF_WITH_FAST_LINE_INPUT 0
+# endif
+# ifndef CONF_WITH_FLOPPY_TRACK_CACHE
+#  define CONF_WITH_FLOPPY_TRACK_CACHE 0
+# endif
+# ifndef CONF_WITH_GLYPH_CACHE
+#  define CONF_WITH_GLYPH_CACHE 0
+# endif
+# ifndef CONF_WITH_VDI_BATCH
+#  define CONF_WITH_VDI_BATCH 0
+# endif
+# ifndef CONF_WITH_MOUSE_PRESHIFT
+#  define CONF_WITH_MOUSE_PRESHIFT 0
+# endif
+# ifndef CONF_WITH_MOUSE_SHIELD
+#  define CONF_WITH_MOUSE_SHIELD 0
+# endif
+# ifndef OBJC_CACHE_SIZE
+#  define OBJC_CACHE_SIZE 0
+# endif
+# ifndef OSMEM_MAX_BLOCKS
+#  define OSMEM_MAX_BLOCKS 0
+# endif
 # ifndef CONF_WITH_EXTENDED_MOUSE
 #  define CONF_WITH_EXTENDED_MOUSE 0
 # endif
@@ -488,6 +524,42 @@
 # ifndef CONF_WITH_BIOS_EXTENSIONS
 #  define CONF_WITH_BIOS_EXTENSIONS 0
 # endif
+# ifndef CONF_WITH_IO_STATS
+#  define CONF_WITH_IO_STATS 0
+# endif
+# ifndef CONF_WITH_IDLE_STATS
+#  define CONF_WITH_IDLE_STATS 0
+# endif
+# ifndef CONF_WITH_MEMORY_STATS
+#  define CONF_WITH_MEMORY_STATS 0
+# endif
+# ifndef CONF_WITH_BLOCK_CONOUT
+#  define CONF_WITH_BLOCK_CONOUT 0
+# endif
+# ifndef CONF_WITH_FAST_LINE_INPUT
+#  define CONF_WITH_FAST_LINE_INPUT 0
+# endif
+# ifndef CONF_WITH_FLOPPY_TRACK_CACHE
+#  define CONF_WITH_FLOPPY_TRACK_CACHE 0
+# endif
+# ifndef CONF_WITH_GLYPH_CACHE
+#  define CONF_WITH_GLYPH_CACHE 0
+# endif
+# ifndef CONF_WITH_VDI_BATCH
+#  define CONF_WITH_VDI_BATCH 0
+# endif
+# ifndef CONF_WITH_MOUSE_PRESHIFT
+#  define CONF_WITH_MOUSE_PRESHIFT 0
+# endif
+# ifndef CONF_WITH_MOUSE_SHIELD
+#  define CONF_WITH_MOUSE_SHIELD 0
+# endif
+# ifndef OBJC_CACHE_SIZE
+#  define OBJC_CACHE_SIZE 0
+# endif
+# ifndef OSMEM_MAX_BLOCKS
+#  define OSMEM_MAX_BLOCKS 0
+# endif
 # ifndef CONF_WITH_EXTENDED_MOUSE
 #  define CONF_WITH_EXTENDED_MOUSE 0
 # endif
@@ -1061,6 +1133,20 @@
 # define CONF_WITH_FDC 1
 #endif
 
+/*
+ * Set CONF_WITH_FLOPPY_TRACK_CACHE to 1 to read entire floppy tracks into
+ * a cache, so that sequential reads do not cost a disk revolution each.
+ * This uses 18 KB of ST-RAM when floppy drives are present.  It is only
+ * implemented for the Atari FDC (the Amiga has its own track cache).
+ */
+#ifndef CONF_WITH_FLOPPY_TRACK_CACHE
+# if CONF_WITH_FDC
+#  define CONF_WITH_FLOPPY_TRACK_CACHE 1
+# else
+#  define CONF_WITH_FLOPPY_TRACK_CACHE 0
+# endif
+#endif
+
 /*
  * Set this to 1 to activate ACSI support
  */
@@ -1134,6 +1220,32 @@
 # define CONF_VRAM_ADDRESS 0
 #endif
 
+/*
+ * Set CONF_WITH_VIRTUAL_SCROLL to 1 to make the VT52 console scroll the
+ * whole screen by moving the screen base address within a larger block
+ * of screen memory, rather than by copying the screen contents.  This
+ * is much faster, but costs half a screen of extra ST-RAM, and it changes
+ * Logbase()/Physbase() while the console scrolls, which confuses programs
+ * that mix console output with direct screen access.  It is not used on
+ * the Falcon, nor when CONF_VRAM_ADDRESS is set.
+ */
+#ifndef CONF_WITH_VIRTUAL_SCROLL
+# define CONF_WITH_VIRTUAL_SCROLL 0
+#endif
+
+/*
+ * Set CONF_WITH_GLYPH_CACHE to 1 to keep recently-used characters of the
+ * VT52 console pre-expanded for the current colours in 2, 4 and 8 plane
+ * modes.
+ * GLYPH_CACHE_SIZE is the size of the cache in bytes.
+ */
+#ifndef CONF_WITH_GLYPH_CACHE
+# define CONF_WITH_GLYPH_CACHE 1
+#endif
+#ifndef GLYPH_CACHE_SIZE
+# define GLYPH_CACHE_SIZE 2048
+#endif
+
 /*
  * Set CONF_WITH_MEGARTC to 1 to enable MegaST real-time clock support
  */
@@ -1299,6 +1411,27 @@
 # define CONF_WITH_COLOUR_ICONS 1
 #endif
 
+/*
+ * CICON_CACHE_SIZE is the maximum size (in bytes) of the cache of colour
+ * icons converted by rsrc_load().  The cache is allocated when the
+ * desktop starts in a colour resolution, and lets programs that load
+ * the same resource file again skip the conversion.  Set it to 0 to
+ * disable the cache.
+ */
+#ifndef CICON_CACHE_SIZE
+# define CICON_CACHE_SIZE 65536L
+#endif
+
+/*
+ * OBJC_CACHE_SIZE is the maximum size (in bytes) of the buffer used by
+ * the AES to keep images of the menus and alerts it draws, so that they
+ * can be blitted rather than drawn again when they look the same.  Set
+ * it to 0 to disable the cache.
+ */
+#ifndef OBJC_CACHE_SIZE
+# define OBJC_CACHE_SIZE 32768L
+#endif
+
 /*
  * Set CONF_WITH_EXTENDED_OBJECTS to 1 to include AES support for a
  * number of MagiC-style object type extensions
@@ -1361,6 +1494,16 @@
 # define CONF_WITH_WINDOW_COLOURS 1
 #endif
 
+/*
+ * NUM_ORECT_RESERVE is the number of window rectangle list entries that
+ * the AES allocates at startup in addition to its fixed pool.  They are
+ * needed when many windows overlap; if all entries are in use, parts of
+ * windows may not be redrawn.  Each entry uses 12 bytes of RAM.
+ */
+#ifndef NUM_ORECT_RESERVE
+# define NUM_ORECT_RESERVE 256
+#endif
+
 /*
  * Define the AES version here. This must be done at the end of the
  * "Software Section - AES", since the value depends on features that
@@ -1520,6 +1663,56 @@
 # define CONF_WITH_BIOS_EXTENSIONS 1
 #endif
 
+/*
+ * Set CONF_WITH_IO_STATS to 1 to count the bytes transferred by GEMDOS
+ * Fread()/Fwrite() on files, and the physical sectors transferred by
+ * Rwabs().  The counters are published via the EIOS cookie; they are
+ * used by the EmuCON2 'time' command.
+ */
+#ifndef CONF_WITH_IO_STATS
+# define CONF_WITH_IO_STATS 1
+#endif
+
+/*
+ * Set CONF_WITH_IDLE_STATS to 1 to count the 200 Hz timer ticks spent
+ * waiting for console input or AES events.  The counters are published
+ * via the EIDL cookie; they are used by the EmuCON2 'time' command.
+ */
+#ifndef CONF_WITH_IDLE_STATS
+# define CONF_WITH_IDLE_STATS 1
+#endif
+
+/*
+ * Set CONF_WITH_MEMORY_STATS to 1 to provide the EmuTOS GEMDOS extension
+ * Mstat(), which returns statistics about the user memory pools and the
+ * OS internal memory pool: free & used blocks, largest free block, sizes
+ * of the free blocks, memory used per process.  It is used by the EmuCON2
+ * 'mem' command.
+ */
+#ifndef CONF_WITH_MEMORY_STATS
+# define CONF_WITH_MEMORY_STATS 1
+#endif
+
+/*
+ * Set CONF_WITH_BLOCK_CONOUT to 1 to let the BDOS output runs of printable
+ * characters written by Cconws() or Fwrite() to the console in one BIOS
+ * call, with a single check for control-S/control-C per run.  The BIOS
+ * trap and Bconout() vectors are bypassed only while they are not hooked.
+ */
+#ifndef CONF_WITH_BLOCK_CONOUT
+# define CONF_WITH_BLOCK_CONOUT 1
+#endif
+
+/*
+ * Set CONF_WITH_FAST_LINE_INPUT to 1 to let Cconrs() and Fread() from the
+ * console store all the printable characters already available (e.g. when
+ * text is pasted into a serial terminal) before echoing them as a block,
+ * instead of echoing each character before reading the next one.
+ */
+#ifndef CONF_WITH_FAST_LINE_INPUT
+# define CONF_WITH_FAST_LINE_INPUT 1
+#endif
+
 /*
  * Set CONF_WITH_EXTENDED_MOUSE to 1 to enable extended mouse support.
  * This includes new Eiffel scancodes for mouse buttons 3, 4, 5, and
@@ -1543,6 +1736,35 @@
 # define CONF_WITH_MEMORY_TEST 0
 #endif
 
+/*
+ * Set CONF_WITH_BOOT_PROFILER to 1 to record the hz_200 value at the end
+ * of each boot stage (and after each AUTO program).  The table is sent to
+ * the debug console before the shell is started, and remains available
+ * in memory via the EBPR cookie.  BOOTPROF_MAX_ENTRIES is the maximum
+ * number of stages that are recorded.
+ */
+#ifndef CONF_WITH_BOOT_PROFILER
+# define CONF_WITH_BOOT_PROFILER 0
+#endif
+#ifndef BOOTPROF_MAX_ENTRIES
+# define BOOTPROF_MAX_ENTRIES 64
+#endif
+
+/*
+ * Set CONF_WITH_KTRACE to 1 to record binary events (disk buffer lookups,
+ * Rwabs(), Pexec(), Mxalloc(), ...) in a ring buffer in RAM.  Unlike
+ * KDEBUG() output, this hardly affects the timing of the system.  The
+ * buffer is available via the EKTR cookie, and may be displayed by the
+ * EmuCON2 'trace' command.  KTRACE_EVENTS is the size of the ring buffer,
+ * and must be a power of 2.
+ */
+#ifndef CONF_WITH_KTRACE
+# define CONF_WITH_KTRACE 0
+#endif
+#ifndef KTRACE_EVENTS
+# define KTRACE_EVENTS 256
+#endif
+
 /*
  * Set CONF_WITH_XBIOS_SOUND to 1 to enable support for the XBIOS sound
  * extension.  This extension provides (some of) the Falcon XBIOS sound
@@ -1577,6 +1799,37 @@
 # define HD_DETECT_RETRIES 0
 #endif
 
+/*
+ * The OS internal memory pool, which holds the DNDs, OFDs, DMDs and MDs
+ * (see doc/osmemory.txt), starts with a fixed number of blocks.  When it
+ * runs low, it grows by OSMEM_GROW_BLOCKS blocks at a time, allocated
+ * from the user memory, until OSMEM_MAX_BLOCKS blocks have been added.
+ * Only then are cached directory nodes (DNDs) discarded to make room.
+ * Set OSMEM_MAX_BLOCKS to 0 for a fixed size pool, as in Atari TOS.
+ */
+#ifndef OSMEM_GROW_BLOCKS
+# define OSMEM_GROW_BLOCKS 32
+#endif
+#ifndef OSMEM_MAX_BLOCKS
+# define OSMEM_MAX_BLOCKS 1024
+#endif
+
+/*
+ * Set CONF_WITH_SHARED_ENV to 1 to let a program started by Pexec() mode 0
+ * with a NULL environment use the environment of its parent, instead of
+ * a copy of it.  The parent is suspended while the child runs, so the
+ * environment cannot change under the child.  Mfree() of the shared
+ * environment by the child is ignored, Mshrink() of it is refused, and a
+ * private copy is made if the child terminates and stays resident.
+ *
+ * This is disabled by default because, without an MMU, writes by the
+ * child to its environment (e.g. tokenising PATH in place) cannot be
+ * detected, so they are seen by the parent, unlike with Atari TOS.
+ */
+#ifndef CONF_WITH_SHARED_ENV
+# define CONF_WITH_SHARED_ENV 0
+#endif
+
 /*
  * Set CONF_WITH_1FAT_SUPPORT to 1 to enable support for filesystems with
  * only one file allocation table (FAT) instead of the usual two FATs.
@@ -1662,6 +1915,35 @@
 # define CONF_WITH_VDI_VERTLINE 1
 #endif
 
+/*
+ * Set CONF_WITH_VDI_BATCH to 1 to provide the EmuTOS v_escape() extension
+ * that lets a workstation batch rectangle fills: fills are queued, merged
+ * and culled, then drawn when the batch ends.  The AES uses it when
+ * redrawing window borders.
+ */
+#ifndef CONF_WITH_VDI_BATCH
+# define CONF_WITH_VDI_BATCH 1
+#endif
+
+/*
+ * Set CONF_WITH_MOUSE_PRESHIFT to 1 to keep copies of the mouse form
+ * pre-shifted to each pixel position within a screen word, so that the
+ * mouse cursor can be drawn without shifting the form each time
+ */
+#ifndef CONF_WITH_MOUSE_PRESHIFT
+# define CONF_WITH_MOUSE_PRESHIFT 1
+#endif
+
+/*
+ * Set CONF_WITH_MOUSE_SHIELD to 1 to provide the EmuTOS v_escape()
+ * extension that hides the mouse cursor only if it is in the way of
+ * the area about to be drawn.  The AES uses it when drawing objects
+ * and updating windows.
+ */
+#ifndef CONF_WITH_MOUSE_SHIELD
+# define CONF_WITH_MOUSE_SHIELD 1
+#endif
+
 /*
  * The VDI functions v_fillarea(), v_pline(), v_pmarker() can handle
  * up to MAX_VERTICES coordinates (MAX_VERTICES/2 points).
@@ -1671,6 +1953,16 @@
 # define MAX_VERTICES 1024
 #endif
 
+/*
+ * v_contourfill() keeps track of the spans it has found in a pool that
+ * initially uses a shared VDI work area.  If that is exhausted, the pool
+ * grows by allocating blocks of FILL_SPAN_BLOCK_SIZE bytes, which are
+ * freed at the end of the fill.
+ */
+#ifndef FILL_SPAN_BLOCK_SIZE
+# define FILL_SPAN_BLOCK_SIZE 8192
+#endif
+
 /*
  * VDI configuration
  */
@@ -1898,6 +2190,18 @@
 # define USE_STOP_INSN_TO_FREE_HOST_CPU 1
 #endif
 
+/*
+ * Set USE_STOP_INSN_WHEN_IDLE to 1 to stop the CPU while waiting for
+ * console input or AES events (see idle_wait()).  This is safe as long as
+ * the wait is ended by an interrupt, such as the 200 Hz system timer, and
+ * it reduces power consumption on real hardware.  It may be enabled
+ * separately from USE_STOP_INSN_TO_FREE_HOST_CPU, which also affects
+ * other delay loops.
+ */
+#ifndef USE_STOP_INSN_WHEN_IDLE
+# define USE_STOP_INSN_WHEN_IDLE USE_STOP_INSN_TO_FREE_HOST_CPU
+#endif
+
 /*
  * Set STONX_NATIVE_PRINT to 1 if your emulator provides a STonX-like
  * native_print() function, i.e. if the code:
@@ -2154,6 +2458,9 @@
 # if CONF_WITH_VIDEL
 #  error CONF_WITH_VIDEL requires CONF_WITH_ATARI_VIDEO.
 # endif
+# if CONF_WITH_VIRTUAL_SCROLL
+#  error CONF_WITH_VIRTUAL_SCROLL requires CONF_WITH_ATARI_VIDEO.
+# endif
 #endif
 
 #if !CONF_SERIAL_CONSOLE
@@ -74,6 +74,10 @@
 # ifndef USE_STOP_INSN_TO_FREE_HOST_CPU
 #  define USE_STOP_INSN_TO_FREE_HOST_CPU 0
 # endif
+/* idle waits are ended by the DUART receive & timer interrupts */
+# ifndef USE_STOP_INSN_WHEN_IDLE
+#  define USE_STOP_INSN_WHEN_IDLE 1
+# endif
 # ifndef DETECT_NATIVE_FEATURES
 #  define DETECT_NATIVE_FEATURES 0
 # endif
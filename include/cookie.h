@@ -42,6 +42,10 @@ struct cookie {
 #define COOKIE__5MS     0x5f354d53L
 #define COOKIE_NVDI     0x4e564449L
 #define COOKIE_SCSIDRIV 0x53435349L
+#define COOKIE_BOOTPROF 0x45425052L  /* 'EBPR': boot profile, see bios/bootprof.h */
+#define COOKIE_IOSTATS  0x45494f53L  /* 'EIOS': I/O counters, see include/biosext.h */
+#define COOKIE_IDLESTATS 0x4549444cL /* 'EIDL': idle counters, see include/biosext.h */
+#define COOKIE_KTRACE   0x454b5452L  /* 'EKTR': kernel event trace, see include/ktrace.h */
 
 /*
  * values of _MCH cookie
@@ -1,7 +1,7 @@
 /*
  * gemdos.h - EmuTOS interface to GEMDOS
  *
- * Copyright (C) 2002-2023 The EmuTOS development team
+ * Copyright (C) 2002-2026 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -15,9 +15,12 @@
 WORD pgmld(WORD handle, char *pname, LONG **ldaddr);
 LONG dos_exec(WORD mode, const char *pcspec, const char *pcmdln, const char *segenv); /* see: gemstart.S */
 WORD dos_setdt(UWORD h, UWORD time, UWORD date);
+WORD dos_getdt(UWORD h, UWORD *time, UWORD *date);
 WORD dos_label(char drive, char *plabel);
 void dos_space(WORD drv, LONG *ptotal, LONG *pavail);
 LONG dos_load_file(char *filename, LONG count, char *buf);
+WORD dos_sfirst_bulk(char *pspec, WORD attr);
+WORD dos_snext_bulk(void);
 
 void *dos_alloc_stram(LONG nbytes);
 void *dos_alloc_anyram(LONG nbytes);
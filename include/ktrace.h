@@ -0,0 +1,76 @@
+/*
+ * ktrace.h - kernel event trace
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef _KTRACE_H
+#define _KTRACE_H
+
+/*
+ * event ids
+ *
+ * these are also known to the EmuCON2 'trace' command (see cli/cmd.h);
+ * add new ones at the end, and don't change existing ones.
+ */
+#define KT_GETBCB       1   /* getbcb(): drive, buffer type, record, 1 if hit */
+#define KT_RWABS        2   /* Rwabs() start: rw flags, device, record, count */
+#define KT_RWABS_DONE   3   /* Rwabs() end: return code */
+#define KT_PEXEC        4   /* Pexec(): mode, 8 chars of the filename */
+#define KT_PEXEC_LOADED 5   /* Pexec() load done: basepage, text length */
+#define KT_PTERM        6   /* Pterm(): basepage, return code */
+#define KT_MXALLOC      7   /* Malloc()/Mxalloc(): amount, mode, result */
+#define KT_PEXEC_TIMES  8   /* Pexec() phase times in ticks: basepage,
+                             * lookup<<16|load, reloc<<16|clear, start */
+
+#if CONF_WITH_KTRACE
+
+#define KTRACE_VERSION  1
+
+/*
+ * one event.  all events have the same size, whatever the number of
+ * arguments, so that recording one is cheap.
+ */
+typedef struct {
+    ULONG ticks;                /* hz_200 when the event was recorded */
+    UWORD id;                   /* KT_xxx */
+    UWORD seq;                  /* low word of the event number */
+    ULONG arg[4];
+} KTRACE_EVENT;
+
+/*
+ * the ring buffer, pointed to by the cookie COOKIE_KTRACE
+ *
+ * 'count' is the total number of events recorded since boot (or since
+ * it was last reset to zero); the most recent event is in
+ * event[(count-1) % max].  events are only recorded while 'enabled'
+ * is nonzero.
+ */
+typedef struct {
+    UWORD version;              /* KTRACE_VERSION */
+    UWORD max;                  /* size of event[] */
+    UWORD hz;                   /* timer frequency of 'ticks' */
+    UWORD enabled;
+    ULONG count;
+    KTRACE_EVENT event[KTRACE_EVENTS];
+} KTRACE;
+
+extern KTRACE ktrace;
+
+void ktrace_init(void);
+void ktrace_event(UWORD id, ULONG a0, ULONG a1, ULONG a2, ULONG a3);
+void ktrace_file(UWORD id, ULONG a0, const char *path, ULONG a3);
+
+#define KTRACE(id,a0,a1,a2,a3) \
+    ktrace_event(id, (ULONG)(a0), (ULONG)(a1), (ULONG)(a2), (ULONG)(a3))
+
+#else
+
+#define KTRACE(id,a0,a1,a2,a3) NULL_FUNCTION()
+
+#endif /* CONF_WITH_KTRACE */
+
+#endif /* _KTRACE_H */
@@ -12,25 +12,29 @@
 #ifndef ASM_SOURCE
 
 /*
- * segment in queue structure used by contourfill()
+ * horizontal span of pixels, as used by contourfill()
+ *
+ * every span found is entered in a hash chain (so that it is never
+ * visited again) and, until it has been drawn, in the list of pending
+ * spans
  */
-typedef struct {
-    WORD y;                     /* y coordinate of segment and/or special value */
-    WORD xleft;                 /* x coordinate of segment start */
-    WORD xright;                /* x coordinate of segment end */
-} SEGMENT;
+typedef struct fillspan FILLSPAN;
+struct fillspan {
+    WORD y;                     /* y coordinate of span */
+    WORD xleft;                 /* x coordinate of span start */
+    WORD xright;                /* x coordinate of span end */
+    FILLSPAN *hnext;            /* next span in same hash chain */
+    FILLSPAN *pnext;            /* next pending span */
+};
 
 /*
- * queue size for contourfill()
- *
- * this is currently made as large as will fit in the existing vdishare
- * area without increasing it (see below).
+ * number of spans in the initial contourfill() span pool
  *
- * in order to be guaranteed to handle all possible shapes of fill area,
- * the number of entries probably needs to be greater than or equal to
- * the current horizontal screen resolution.
+ * this is made as large as will fit in the existing vdishare area
+ * without increasing it (see below).  when it is exhausted, further
+ * spans are allocated in blocks of FILL_SPAN_BLOCK_SIZE bytes.
  */
-#define QSIZE   (sizeof(struct vsmain)/sizeof(SEGMENT))
+#define FILL_NSPANS (sizeof(struct vsmain)/sizeof(FILLSPAN))
 
 /*
  * text scratch buffer size (in bytes)
@@ -50,7 +54,7 @@ typedef union {
         WORD local_ptsin[2*MAX_VERTICES];   /* used by GSX_ENTRY() - must be at offset 0 */
         WORD fill_buffer[MAX_VERTICES];     /* used by clc_flit() */
     } main;
-    SEGMENT queue[QSIZE];       /* storage for contourfill() seed points  */
+    FILLSPAN spans[FILL_NSPANS];    /* initial contourfill() span pool */
     WORD deftxbuf[SCRATCHBUF_SIZE/sizeof(WORD)];    /* text scratch buffer */
 } VDISHARE;
 
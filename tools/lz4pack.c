@@ -0,0 +1,281 @@
+/*
+ * lz4pack.c - compress emutos.img for unpacking in place at boot
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/*
+ * This tool compresses a RAM-loaded image (e.g. emutos.img for the SBC
+ * targets) using the LZ4 block format, which can be unpacked by a tiny
+ * and fast 68000 routine (see util/unpack.S).
+ *
+ * The output file starts with a header of 3 big-endian longs:
+ *      raw size        size of the unpacked image
+ *      packed size     size of the LZ4 data following the header
+ *      offset          where the LZ4 data must be placed, relative to
+ *                      the start of the unpacked image, so that it can
+ *                      be unpacked in place
+ *
+ * The offset is computed by simulating the unpacking: at any time, the
+ * bytes written must not overwrite packed data that has not been read.
+ * It is a multiple of 4, so that the data can be moved by longwords.
+ *
+ * The packed data is checked by unpacking it before it is written.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_MATCH       4           /* LZ4 minimum match length */
+#define MAX_OFFSET      65535       /* LZ4 maximum match offset */
+#define LAST_LITERALS   5           /* LZ4: the last bytes are literals */
+#define HASH_BITS       16
+#define HASH_SIZE       (1L << HASH_BITS)
+#define MAX_CHAIN       64          /* max # of candidates tried per position */
+#define MIN_OFFSET      256         /* min offset of packed data from image */
+
+static unsigned char *raw, *packed;
+static long rawsize, packedsize;
+static long head[HASH_SIZE];        /* most recent position for each hash */
+static long *chain;                 /* previous position with the same hash */
+static long maxgap;                 /* max(written - read) while unpacking */
+
+static void fatal(const char *msg, const char *arg)
+{
+    fprintf(stderr, "lz4pack: ");
+    fprintf(stderr, msg, arg);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+static unsigned long hash4(const unsigned char *p)
+{
+    unsigned long v = ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16)
+                    | ((unsigned long)p[2] << 8) | p[3];
+
+    return ((v * 2654435761UL) & 0xffffffffUL) >> (32 - HASH_BITS);
+}
+
+/*
+ * add position 'pos' to the hash chains
+ */
+static void insert(long pos)
+{
+    unsigned long h;
+
+    if (pos + MIN_MATCH > rawsize)
+        return;
+
+    h = hash4(raw + pos);
+    chain[pos] = head[h];
+    head[h] = pos;
+}
+
+/*
+ * find the longest match for position 'pos'; returns its length, or 0
+ */
+static long find_match(long pos, long limit, long *offset)
+{
+    long cand, len, best = 0;
+    int tries = MAX_CHAIN;
+
+    if (pos + MIN_MATCH > limit)
+        return 0;
+
+    for (cand = head[hash4(raw + pos)]; (cand >= 0) && tries--; cand = chain[cand])
+    {
+        if (pos - cand > MAX_OFFSET)
+            break;
+        for (len = 0; (pos + len < limit) && (raw[cand+len] == raw[pos+len]); len++)
+            ;
+        if (len > best)
+        {
+            best = len;
+            *offset = pos - cand;
+        }
+    }
+
+    return (best >= MIN_MATCH) ? best : 0;
+}
+
+static void put_length(long len)
+{
+    while (len >= 255)
+    {
+        packed[packedsize++] = 255;
+        len -= 255;
+    }
+    packed[packedsize++] = (unsigned char)len;
+}
+
+/*
+ * output one sequence: literals from 'lit', then a match (unless
+ * matchlen is 0, for the last sequence)
+ *
+ * also keeps track of the distance between the unpacked data written
+ * and the packed data read so far
+ */
+static void put_sequence(long lit, long litlen, long matchlen, long offset, long *written)
+{
+    unsigned char *token = packed + packedsize++;
+    long gap;
+
+    *token = (unsigned char)(((litlen < 15) ? litlen : 15) << 4);
+    if (litlen >= 15)
+        put_length(litlen - 15);
+    memcpy(packed + packedsize, raw + lit, litlen);
+    packedsize += litlen;
+    *written += litlen;
+
+    if (!matchlen)
+        return;
+
+    packed[packedsize++] = (unsigned char)(offset & 0xff);
+    packed[packedsize++] = (unsigned char)(offset >> 8);
+    matchlen -= MIN_MATCH;
+    *token |= (matchlen < 15) ? matchlen : 15;
+    if (matchlen >= 15)
+        put_length(matchlen - 15);
+    *written += matchlen + MIN_MATCH;
+
+    /* the match is written before the next packed byte is read */
+    gap = *written - packedsize;
+    if (gap > maxgap)
+        maxgap = gap;
+}
+
+static void compress(void)
+{
+    long pos = 0, lit = 0, len, offset = 0, written = 0, i;
+    long limit = rawsize - LAST_LITERALS;
+
+    chain = malloc((rawsize + 1) * sizeof(long));
+    packed = malloc(rawsize + rawsize / 255 + 16);
+    if (!chain || !packed)
+        fatal("%s", "out of memory");
+    for (i = 0; i < HASH_SIZE; i++)
+        head[i] = -1;
+
+    while (pos < limit)
+    {
+        len = find_match(pos, limit, &offset);
+        if (!len)
+        {
+            insert(pos++);
+            continue;
+        }
+        put_sequence(lit, pos - lit, len, offset, &written);
+        for (i = 0; i < len; i++)
+            insert(pos++);
+        lit = pos;
+    }
+
+    put_sequence(lit, rawsize - lit, 0, 0, &written);
+}
+
+/*
+ * unpack the data, exactly like util/unpack.S, and compare with the input
+ */
+static void check(void)
+{
+    unsigned char *out = malloc(rawsize);
+    long in = 0, o = 0, len, offset;
+    int token, n;
+
+    if (!out)
+        fatal("%s", "out of memory");
+
+    for (;;)
+    {
+        token = packed[in++];
+        len = token >> 4;
+        if (len == 15)
+            do { n = packed[in++]; len += n; } while (n == 255);
+        if (o + len > rawsize)
+            fatal("%s", "check failed: literals overflow");
+        memcpy(out + o, packed + in, len);
+        in += len;
+        o += len;
+        if (in >= packedsize)
+            break;
+        offset = packed[in] | (packed[in+1] << 8);
+        in += 2;
+        len = token & 15;
+        if (len == 15)
+            do { n = packed[in++]; len += n; } while (n == 255);
+        len += MIN_MATCH;
+        if ((offset == 0) || (offset > o) || (o + len > rawsize))
+            fatal("%s", "check failed: bad match");
+        for ( ; len; len--, o++)
+            out[o] = out[o-offset];
+    }
+
+    if ((o != rawsize) || memcmp(out, raw, rawsize))
+        fatal("%s", "check failed: data differs");
+
+    free(out);
+}
+
+static void put_long(FILE *f, unsigned long v)
+{
+    putc((int)((v >> 24) & 0xff), f);
+    putc((int)((v >> 16) & 0xff), f);
+    putc((int)((v >> 8) & 0xff), f);
+    putc((int)(v & 0xff), f);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    long offset;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: lz4pack <image> <packed image>\n");
+        return EXIT_FAILURE;
+    }
+
+    f = fopen(argv[1], "rb");
+    if (!f)
+        fatal("cannot open %s", argv[1]);
+    fseek(f, 0L, SEEK_END);
+    rawsize = ftell(f);
+    fseek(f, 0L, SEEK_SET);
+    raw = malloc(rawsize ? rawsize : 1);
+    if (!raw)
+        fatal("%s", "out of memory");
+    if (fread(raw, 1, rawsize, f) != (size_t)rawsize)
+        fatal("cannot read %s", argv[1]);
+    fclose(f);
+
+    compress();
+    check();
+
+    /* place the packed data so that it ends after the unpacked image */
+    offset = rawsize - packedsize;
+    if (offset < maxgap)
+        offset = maxgap;
+    if (offset < MIN_OFFSET)
+        offset = MIN_OFFSET;
+    offset = (offset + 3) & ~3L;
+
+    f = fopen(argv[2], "wb");
+    if (!f)
+        fatal("cannot create %s", argv[2]);
+    put_long(f, rawsize);
+    put_long(f, packedsize);
+    put_long(f, offset);
+    if (fwrite(packed, 1, packedsize, f) != (size_t)packedsize)
+        fatal("cannot write %s", argv[2]);
+    fclose(f);
+
+    printf("# %s: %ld bytes packed into %ld (%ld%%), unpacking uses %ld bytes\n",
+            argv[1], rawsize, packedsize, packedsize * 100 / (rawsize ? rawsize : 1),
+            offset + packedsize);
+
+    return EXIT_SUCCESS;
+}
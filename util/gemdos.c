@@ -6,7 +6,7 @@
 /*      GEMDOSIF.C      5/15/85 - 6/4/85        MDF                     */
 
 /*
-*       Copyright (C) 2002-2023 The EmuTOS development team
+*       Copyright (C) 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -24,6 +24,15 @@
 #include "asm.h"
 #include "gemdos.h"
 #include "bdosbind.h"
+#include "gemerror.h"
+
+
+#define DIRBUF_ENTRIES  16      /* directory entries fetched per Fsnextm() */
+
+static DIRENTRY dirbuf[DIRBUF_ENTRIES];
+static WORD dirbuf_count, dirbuf_next;
+static BOOL dirbuf_bulk;        /* FALSE if Fsnextm() is not available */
+static DTA *dirbuf_dta;
 
 
 WORD pgmld(WORD handle, char *pname, LONG **ldaddr)
@@ -55,6 +64,18 @@ WORD dos_setdt(UWORD h, UWORD time, UWORD date)
     return Fdatime(buf,h,TRUE);
 }
 
+WORD dos_getdt(UWORD h, UWORD *time, UWORD *date)
+{
+    UWORD   buf[2];
+    WORD    rc;
+
+    rc = Fdatime(buf,h,FALSE);
+    *time = buf[0];
+    *date = buf[1];
+
+    return rc;
+}
+
 
 WORD dos_label(char drive, char *plabel)
 {
@@ -160,3 +181,48 @@ LONG dos_load_file(char *filename, LONG count, char *buf)
 
     return ret;
 }
+
+
+/*
+ *  Directory search functions, used like dos_sfirst()/dos_snext().
+ *
+ *  The entries after the first are fetched DIRBUF_ENTRIES at a time via
+ *  the EmuTOS extension Fsnextm(), and returned one at a time in the
+ *  DTA.  If another GEMDOS is installed, we use Fsnext() instead.
+ *
+ *  Only one such search can be in progress at a time.
+ */
+WORD dos_sfirst_bulk(char *pspec, WORD attr)
+{
+    dirbuf_count = dirbuf_next = 0;
+    dirbuf_bulk = TRUE;
+    dirbuf_dta = dos_gdta();
+
+    return dos_sfirst(pspec, attr);
+}
+
+
+WORD dos_snext_bulk(void)
+{
+    LONG ret;
+
+    if (dirbuf_next >= dirbuf_count)
+    {
+        if (!dirbuf_bulk)
+            return dos_snext();
+        ret = Fsnextm(dirbuf, (LONG)sizeof(dirbuf));
+        if (ret == EINVFN)
+        {
+            dirbuf_bulk = FALSE;
+            return dos_snext();
+        }
+        if (ret < 0)
+            return ret;
+        dirbuf_count = ret;
+        dirbuf_next = 0;
+    }
+
+    memcpy(&dirbuf_dta->d_attrib, &dirbuf[dirbuf_next++].d_attrib, sizeof(DIRENTRY)-1);
+
+    return 0;
+}
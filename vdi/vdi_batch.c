@@ -0,0 +1,363 @@
+/*
+ * vdi_batch.c - batching of VDI rectangle fills
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/*
+ * A workstation may bracket a series of VDI calls with the EmuTOS
+ * escape VBATCH_ESCAPE (INTIN[0] = 1 to begin, 0 to end).  While the
+ * batch is open, vr_recfl() calls for that workstation are queued
+ * instead of being drawn immediately:
+ *  . a new fill with the same attributes as a queued one is merged
+ *    with it if the two rectangles together form a rectangle
+ *  . queued fills that are completely overdrawn by a new replace-mode
+ *    fill, or by an opaque vro_cpyfm() from memory, are discarded
+ *
+ * The queue is drawn in order when the batch ends, when the queue is
+ * full, and before any other VDI call that may draw to or read from
+ * the screen.  Calls that only set or inquire attributes, and raster
+ * copies between memory forms, leave the queue alone.  While a batch
+ * is open, the mouse cursor is not redrawn between a v_show_c() and a
+ * following v_hide_c() (see vdi_mouse.c).
+ *
+ * Only one batch may be open at a time: an attempt to begin a batch on
+ * another workstation fails.  The batch is ended if its workstation is
+ * closed.
+ */
+
+/* #define ENABLE_KDEBUG */
+
+#include "emutos.h"
+#include "vdi_defs.h"
+#include "lineavars.h"
+#include "tosvars.h"
+
+#if CONF_WITH_VDI_BATCH
+
+#define VBATCH_MAX      32      /* max # of queued fills */
+
+typedef struct {
+    Rect rect;                  /* rectangle, already clipped */
+    VwkAttrib attr;             /* attributes when the fill was requested */
+} BATCHFILL;
+
+static Vwk *batch_vwk;          /* workstation owning the open batch, or NULL */
+static WORD batch_count;        /* # of queued fills */
+static BATCHFILL batch_queue[VBATCH_MAX];
+static UWORD batch_requested;   /* # of fills requested in the current batch */
+static UWORD batch_drawn;       /* # of fills actually drawn */
+
+
+/*
+ * return TRUE iff rectangle 'in' lies entirely within rectangle 'out'
+ */
+static BOOL rect_inside(const Rect *in, const Rect *out)
+{
+    return (in->x1 >= out->x1) && (in->x2 <= out->x2)
+        && (in->y1 >= out->y1) && (in->y2 <= out->y2);
+}
+
+
+/*
+ * return TRUE iff the rectangles overlap
+ */
+static BOOL rect_overlap(const Rect *a, const Rect *b)
+{
+    return (a->x1 <= b->x2) && (b->x1 <= a->x2)
+        && (a->y1 <= b->y2) && (b->y1 <= a->y2);
+}
+
+
+/*
+ * merge rectangle 'src' into 'dst' if they are adjacent and together
+ * form a rectangle; return TRUE iff merged
+ *
+ * since fill patterns are aligned to screen coordinates, drawing the
+ * merged rectangle gives exactly the same result as drawing both
+ */
+static BOOL rect_merge(Rect *dst, const Rect *src)
+{
+    if ((dst->x1 == src->x1) && (dst->x2 == src->x2))
+    {
+        if (src->y1 == dst->y2 + 1)
+        {
+            dst->y2 = src->y2;
+            return TRUE;
+        }
+        if (src->y2 + 1 == dst->y1)
+        {
+            dst->y1 = src->y1;
+            return TRUE;
+        }
+    }
+
+    if ((dst->y1 == src->y1) && (dst->y2 == src->y2))
+    {
+        if (src->x1 == dst->x2 + 1)
+        {
+            dst->x2 = src->x2;
+            return TRUE;
+        }
+        if (src->x2 + 1 == dst->x1)
+        {
+            dst->x1 = src->x1;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+static BOOL same_attr(const VwkAttrib *a, const VwkAttrib *b)
+{
+    return (a->patptr == b->patptr) && (a->patmsk == b->patmsk)
+        && (a->multifill == b->multifill) && (a->wrt_mode == b->wrt_mode)
+        && (a->color == b->color);
+}
+
+
+/*
+ * discard all queued fills that lie entirely within the specified
+ * rectangle, which is about to be overdrawn
+ */
+static void cull_fills(const Rect *rect)
+{
+    BATCHFILL *src, *dst;
+    WORD i;
+
+    for (i = batch_count, src = dst = batch_queue; i > 0; i--, src++)
+    {
+        if (rect_inside(&src->rect, rect))
+        {
+            batch_count--;
+            continue;
+        }
+        if (dst != src)
+            *dst = *src;
+        dst++;
+    }
+}
+
+
+/*
+ * return TRUE iff the memory form overlaps screen memory
+ */
+static BOOL form_is_screen(const MFDB *form)
+{
+    const UBYTE *start = form->fd_addr;
+    const UBYTE *end;
+
+    if (!start)
+        return TRUE;
+
+    end = start + (LONG)form->fd_wdwidth * 2 * form->fd_nplanes * form->fd_h;
+
+    return (start < v_bas_ad + (LONG)v_lin_wr * V_REZ_VT) && (end > v_bas_ad);
+}
+
+
+/*
+ * handle a raster copy during a batch
+ *
+ * returns TRUE if the queue need not be drawn first, i.e. the copy
+ * neither reads nor writes the screen
+ */
+static BOOL check_raster(Vwk *vwk, WORD opcode)
+{
+    const MFDB *src = *(MFDB **)&CONTRL[7];
+    const MFDB *dst = *(MFDB **)&CONTRL[9];
+    Rect srect, rect;
+
+    if (form_is_screen(src))
+        return FALSE;
+
+    if (!form_is_screen(dst))
+        return TRUE;
+
+    /*
+     * an opaque copy in replace mode from memory to the screen overwrites
+     * everything within the (clipped) destination rectangle.  like the
+     * copy itself (see do_clip() in vdi_raster.c), the size of that
+     * rectangle is taken from the source rectangle: the lower right
+     * corner of the destination is ignored.
+     */
+    if ((opcode == 109) && (INTIN[0] == 3) && !dst->fd_addr
+     && (src->fd_nplanes == v_planes))
+    {
+        srect = *(Rect *)PTSIN;
+        arb_corner(&srect);
+        rect = *(Rect *)(PTSIN+4);
+        arb_corner(&rect);
+        rect.x2 = rect.x1 + (srect.x2 - srect.x1);
+        rect.y2 = rect.y1 + (srect.y2 - srect.y1);
+        if (!vwk->clip || clipbox(VDI_CLIP(vwk), &rect))
+            cull_fills(&rect);
+    }
+
+    return FALSE;
+}
+
+
+/*
+ * draw all queued fills
+ */
+void vbatch_flush(void)
+{
+    BATCHFILL *q;
+    WORD i;
+
+    for (i = 0, q = batch_queue; i < batch_count; i++, q++)
+        draw_rect_common(&q->attr, &q->rect);
+
+    batch_drawn += batch_count;
+    batch_count = 0;
+}
+
+
+/*
+ * queue a rectangle fill, if a batch is open for this workstation
+ *
+ * returns TRUE if the fill has been queued, FALSE if the caller must
+ * draw it
+ */
+BOOL vbatch_add_fill(const Vwk *vwk, const Rect *rect, UWORD color)
+{
+    BATCHFILL *q;
+    VwkAttrib attr;
+    WORD i;
+
+    if (!batch_vwk || (vwk != batch_vwk))
+        return FALSE;
+
+    batch_requested++;
+    Vwk2Attrib(vwk, &attr, color);
+
+    if (attr.wrt_mode == WM_REPLACE)
+        cull_fills(rect);
+
+    /*
+     * try to merge with a queued fill.  merging moves the new fill
+     * before any fills queued after that one, so we must stop at the
+     * first of those that the new fill overlaps.
+     */
+    for (i = batch_count-1, q = batch_queue+i; i >= 0; i--, q--)
+    {
+        if (same_attr(&q->attr, &attr) && rect_merge(&q->rect, rect))
+            return TRUE;
+        if (rect_overlap(&q->rect, rect))
+            break;
+    }
+
+    if (batch_count >= VBATCH_MAX)
+        vbatch_flush();
+
+    q = &batch_queue[batch_count++];
+    q->rect = *rect;
+    q->attr = attr;
+
+    return TRUE;
+}
+
+
+/*
+ * called by the VDI dispatcher before every VDI call
+ *
+ * draws the queued fills unless the call is known not to depend on
+ * or affect the screen contents
+ */
+void vbatch_check(Vwk *vwk, WORD opcode)
+{
+    if (!batch_vwk)
+        return;
+
+    if (vwk == batch_vwk)
+    {
+        switch(opcode) {
+        case 12: case 13: case 15: case 16: case 17: case 18: case 19:
+        case 20: case 21: case 22: case 23: case 24: case 25: case 26:
+        case 32: case 35: case 36: case 37: case 38: case 39:
+        case 104: case 106: case 107: case 108: case 113: case 114:
+        case 115: case 116: case 117: case 123: case 124: case 128:
+        case 129: case 130: case 131:
+            return;         /* attribute setting/inquiry, vr_recfl, v_hide_c */
+        case 109:           /* vro_cpyfm */
+        case 121:           /* vrt_cpyfm */
+            if (check_raster(vwk, opcode))
+                return;
+            break;
+        }
+    }
+
+    vbatch_flush();
+}
+
+
+/*
+ * called when a workstation is closed (NULL => all workstations)
+ *
+ * ends the batch if it belongs to that workstation, so that the mouse
+ * cursor is not held back forever
+ */
+void vbatch_close(const Vwk *vwk)
+{
+    if (!batch_vwk || (vwk && (vwk != batch_vwk)))
+        return;
+
+    vbatch_flush();
+    batch_vwk = NULL;
+    defer_cursor_show(FALSE);
+}
+
+
+/*
+ * vdi_vbatch - EmuTOS escape: begin/end a batch
+ *
+ * input:
+ *   INTIN[0] = 1 to begin a batch, 0 to end it
+ *
+ * output (when beginning a batch):
+ *   INTOUT[0] = 1 if the batch is open, 0 if another workstation
+ *               already has a batch open
+ *
+ * output (when ending a batch):
+ *   INTOUT[0] = # of fills requested during the batch
+ *   INTOUT[1] = # of fills actually drawn
+ */
+void vdi_vbatch(Vwk *vwk)
+{
+    vbatch_flush();
+
+    if (INTIN[0])
+    {
+        CONTRL[4] = 1;
+        if (batch_vwk && (vwk != batch_vwk))
+        {
+            INTOUT[0] = 0;
+            return;
+        }
+        batch_vwk = vwk;
+        batch_requested = 0;
+        batch_drawn = 0;
+        defer_cursor_show(TRUE);
+        INTOUT[0] = 1;
+        return;
+    }
+
+    if (vwk != batch_vwk)
+        return;
+
+    batch_vwk = NULL;
+    defer_cursor_show(FALSE);
+
+    KDEBUG(("VDI batch: %u fills requested, %u drawn\n",batch_requested,batch_drawn));
+    INTOUT[0] = batch_requested;
+    INTOUT[1] = batch_drawn;
+    CONTRL[4] = 2;
+}
+
+#endif /* CONF_WITH_VDI_BATCH */
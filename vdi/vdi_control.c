@@ -443,6 +443,10 @@ void vdi_v_clsvwk(Vwk * vwk)
     if (!vwk_ptr[handle])           /* workstation is already closed */
         return;
 
+#if CONF_WITH_VDI_BATCH
+    vbatch_close(vwk);              /* end any batch it left open */
+#endif
+
     vwk_ptr[handle] = NULL;         /* close it */
 
     build_vwk_chain();              /* rebuild chain */
@@ -542,6 +546,10 @@ void vdi_v_clswk(Vwk * vwk)
     WORD handle;
     Vwk **p;
 
+#if CONF_WITH_VDI_BATCH
+    vbatch_close(NULL);                 /* end any open batch */
+#endif
+
     /* close all open virtual workstations */
     for (handle = VDI_PHYS_HANDLE+1, p = vwk_ptr+handle; handle <= LAST_VDI_HANDLE; handle++, p++) {
         if (*p) {
@@ -35,6 +35,12 @@
 #define V_OPNVWK_OP     100
 #define V_CLSVWK_OP     101
 
+/*
+ * EmuTOS-specific v_escape() subfunctions
+ */
+#define VBATCH_ESCAPE   0x4554  /* begin/end a batch ('ET') */
+#define VSHIELD_ESCAPE  0x4553  /* hide the cursor if in the way ('ES') */
+
 
 /*
  * some minima and maxima
@@ -136,6 +142,20 @@ typedef struct {
 } VwkAttrib;
 
 
+/* Raster definitions */
+typedef struct {
+    void *fd_addr;
+    WORD fd_w;
+    WORD fd_h;
+    WORD fd_wdwidth;
+    WORD fd_stand;
+    WORD fd_nplanes;
+    WORD fd_r1;
+    WORD fd_r2;
+    WORD fd_r3;
+} MFDB;
+
+
 /* type that can be cast from clipping part of Wvk */
 typedef struct {
     WORD xmn_clip;              /* Low x point of clipping rectangle    */
@@ -270,6 +290,7 @@ extern UBYTE    cur_ms_stat;    /* current mouse status */
 
 
 BOOL clip_line(Vwk *vwk, Line *line);
+BOOL clipbox(const VwkClip *clip, Rect *rect);
 void arb_corner(Rect *rect);
 void arb_line(Line *line);
 
@@ -401,8 +422,22 @@ void vdi_vqt_fontinfo(Vwk *);       /* 131 */
 void vdi_vex_wheelv(Vwk *);         /* 134 */
 #endif
 
+#if CONF_WITH_VDI_BATCH
+/* batching of VDI operations, in vdi_batch.c */
+void vdi_vbatch(Vwk *vwk);
+void vbatch_check(Vwk *vwk, WORD opcode);
+void vbatch_flush(void);
+void vbatch_close(const Vwk *vwk);
+BOOL vbatch_add_fill(const Vwk *vwk, const Rect *rect, UWORD color);
+void defer_cursor_show(BOOL defer);     /* in vdi_mouse.c */
+#endif
+
+#if CONF_WITH_MOUSE_SHIELD
+void vdi_vshield(Vwk *vwk);
+#endif
+
 #if CONF_WITH_VDI_TEXT_SPEEDUP
-void direct_screen_blit(WORD count, WORD *str);
+void direct_screen_blit(const Fonthead *font, WORD count, WORD *str);
 #endif
 
 #if HAVE_BEZIER
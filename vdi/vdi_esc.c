@@ -344,6 +344,20 @@ void vdi_v_escape(Vwk * vwk)
     }
 #endif
 
+#if CONF_WITH_VDI_BATCH
+    if (escfun == VBATCH_ESCAPE) {
+        vdi_vbatch(vwk);        /* begin/end a batch */
+        return;
+    }
+#endif
+
+#if CONF_WITH_MOUSE_SHIELD
+    if (escfun == VSHIELD_ESCAPE) {
+        vdi_vshield(vwk);       /* hide the cursor if in the way */
+        return;
+    }
+#endif
+
     if (escfun > ldri_escape)
         return;
     (*esctbl[escfun])(vwk);
@@ -19,22 +19,33 @@
 #include "vdistub.h"
 #include "tosvars.h"
 #include "lineavars.h"
+#include "bdosbind.h"
 
 
-/* special values used in y member of SEGMENT */
-#define EMPTY       0xffff          /* this entry is unused */
-#define DOWN_FLAG   0x8000
-#define ABS(v)      ((v) & 0x7FFF)  /* strips DOWN_FLAG if present */
-
 /* Global variables */
 static UWORD search_color;      /* selected colour for contourfill() */
 static BOOL seed_type;          /* 1 => fill until selected colour is NOT found */
                                 /* 0 => fill until selected colour is found */
 
-/* the following point to segments within vdishare.queue[] (see below) */
-static SEGMENT *qbottom;        /* the bottom of the queue      */
-static SEGMENT *qtop;           /* the last segment in use +1   */
-static SEGMENT *qptr;           /* points to the active point   */
+/*
+ * the contourfill() span pool: the first spans are in vdishare.spans[]
+ * (see below), further ones in blocks allocated as required
+ */
+typedef struct spanblock SPANBLOCK;
+struct spanblock {
+    SPANBLOCK *prev;            /* previously-allocated block, or NULL */
+    FILLSPAN span[1];           /* actually more */
+};
+#define SPANS_PER_BLOCK ((FILL_SPAN_BLOCK_SIZE-sizeof(SPANBLOCK *))/sizeof(FILLSPAN))
+
+#define SPAN_HASH_SIZE  64      /* must be a power of 2 */
+#define SPAN_HASH(y)    ((y) & (SPAN_HASH_SIZE-1))
+
+static FILLSPAN *span_hash[SPAN_HASH_SIZE]; /* spans found, chained by y */
+static FILLSPAN *pending;       /* spans found but not yet drawn */
+static FILLSPAN *span_next;     /* next free span in pool */
+static FILLSPAN *span_end;      /* end of current pool area */
+static SPANBLOCK *span_blocks;  /* most recently allocated block */
 
 /*
  * a shared area for the VDI
@@ -250,7 +261,7 @@ void vdi_vsf_perimeter(Vwk * vwk)
  *         ->x2 = x coord of lower right corner.
  *         ->y2 = y coord of lower right corner.
  */
-static BOOL clipbox(const VwkClip *clip, Rect *rect)
+BOOL clipbox(const VwkClip *clip, Rect *rect)
 {
     WORD x1, y1, x2, y2;
 
@@ -310,6 +321,11 @@ void vdi_vr_recfl(Vwk * vwk)
         if (!clipbox(VDI_CLIP(vwk), &rect))
             return;
 
+#if CONF_WITH_VDI_BATCH
+    if (vbatch_add_fill(vwk, &rect, vwk->fill_color))
+        return;                 /* queued for later */
+#endif
+
     /* do the real work... */
     draw_rect(vwk, &rect, vwk->fill_color);
 }
@@ -681,200 +697,292 @@ pixelread(const WORD x, const WORD y)
 
 
 
-static UWORD
-search_to_right (const VwkClip * clip, WORD x, UWORD mask, const UWORD search_col, UWORD * addr)
+/*
+ * first_bit - return the index (from the left) of the leftmost 1 bit
+ *             in a non-zero word
+ */
+static WORD first_bit(UWORD mask)
 {
-    /* is x coord < x resolution ? */
-    while( x++ < clip->xmx_clip ) {
-        UWORD color;
-
-        /* need to jump over interleaved bit_plane? */
-        rorw1(mask);    /* rotate right */
-        if ( mask & 0x8000 )
-            addr += v_planes;
-
-        /* search, while pixel color != search color */
-        color = get_color(mask, addr);
-        if ( search_col != color ) {
-            break;
-        }
+    WORD n = 0;
 
+    if (!(mask & 0xff00)) {
+        n += 8;
+        mask <<= 8;
+    }
+    if (!(mask & 0xf000)) {
+        n += 4;
+        mask <<= 4;
     }
+    if (!(mask & 0xc000)) {
+        n += 2;
+        mask <<= 2;
+    }
+    if (!(mask & 0x8000))
+        n++;
 
-    return x - 1;       /* output x coord -1 to endxright. */
+    return n;
 }
 
 
 
-static UWORD
-search_to_left (const VwkClip * clip, WORD x, UWORD mask, const UWORD search_col, UWORD * addr)
+/*
+ * last_bit - return the index (from the left) of the rightmost 1 bit
+ *            in a non-zero word
+ */
+static WORD last_bit(UWORD mask)
 {
-    /* Now, search to the left. */
-    while (x-- > clip->xmn_clip) {
-        UWORD color;
-
-        /* need to jump over interleaved bit_plane? */
-        rolw1(mask);    /* rotate left */
-        if ( mask & 0x0001 )
-            addr -= v_planes;
-
-        /* search, while pixel color != search color */
-        color = get_color(mask, addr);
-        if ( search_col != color )
-            break;
+    WORD n = 15;
 
+    if (!(mask & 0x00ff)) {
+        n -= 8;
+        mask >>= 8;
+    }
+    if (!(mask & 0x000f)) {
+        n -= 4;
+        mask >>= 4;
+    }
+    if (!(mask & 0x0003)) {
+        n -= 2;
+        mask >>= 2;
     }
+    if (!(mask & 0x0001))
+        n--;
 
-    return x + 1;       /* output x coord + 1 to endxleft. */
+    return n;
 }
 
 
 
 /*
- * end_pts - find the endpoints of a section of solid color
- *           (for the contourfill() routine.)
- *
- * input:   clip        ptr to clipping rectangle
- *          x           starting x value
- *          y           y coordinate of line
- *
- * output:  xleftout    ptr to variable to receive leftmost point of this colour
- *          xrightout   ptr to variable to receive rightmost point of this colour
- *
- * returns success flag:
- *          0 => no endpoints or starting x value on edge
- *          1 => endpoints found
+ * inside_mask - return a mask of the 16 pixels at 'addr' (which points
+ *               to the first plane of a screen word group) that belong
+ *               to the area being filled
  */
-static WORD end_pts(const VwkClip *clip, WORD x, WORD y, WORD *xleftout, WORD *xrightout)
+static UWORD inside_mask(const UWORD *addr)
 {
-    UWORD color;
-    UWORD * addr;
-    UWORD mask;
+    UWORD mask = 0xffff;
+    UWORD color = search_color;
+    WORD plane;
+
+    /* compare all planes with the search colour at once */
+    for (plane = v_planes; plane > 0; plane--, color >>= 1) {
+        if (color & 1)
+            mask &= *addr++;
+        else
+            mask &= ~*addr++;
+    }
 
-    /* see, if we are in the y clipping range */
-    if ( y < clip->ymn_clip || y > clip->ymx_clip)
-        return 0;
+    return seed_type ? mask : ~mask;
+}
+
+
+
+/*
+ * next_inside - return the first x coordinate in the range x..limit that
+ *               belongs to the area being filled, or limit+1 if none
+ */
+static WORD next_inside(WORD x, WORD y, WORD limit)
+{
+    const UWORD *addr = get_start_addr(x, y);
+    UWORD mask = inside_mask(addr) & (0xffff >> (x & 0x000f));
+
+    while (!mask) {
+        x = (x | 0x000f) + 1;       /* first pixel of next word */
+        if (x > limit)
+            return limit + 1;
+        addr += v_planes;
+        mask = inside_mask(addr);
+    }
+
+    x = (x & ~0x000f) + first_bit(mask);
+
+    return min(x, limit + 1);
+}
 
-    /* convert x,y to start address and bit mask */
-    addr = get_start_addr(x, y);
-    addr += v_planes;                   /* start at highest-order bit_plane */
-    mask = 0x8000 >> (x & 0x000f);   /* fetch the pixel mask. */
 
-    /* get search color and the left and right end */
-    color = get_color (mask, addr);
-    *xrightout = search_to_right (clip, x, mask, color, addr);
-    *xleftout = search_to_left (clip, x, mask, color, addr);
 
-    /* see, if the whole found segment is of search color? */
-    if ( color != search_color ) {
-        return seed_type ^ 1;   /* return segment not of search color */
+/*
+ * run_right - return the rightmost x coordinate (at most limit) of the
+ *             run of fillable pixels starting at x
+ */
+static WORD run_right(WORD x, WORD y, WORD limit)
+{
+    const UWORD *addr = get_start_addr(x, y);
+    UWORD mask = ~inside_mask(addr) & (0xffff >> (x & 0x000f));
+
+    while (!mask) {
+        x = (x | 0x000f) + 1;       /* first pixel of next word */
+        if (x > limit)
+            return limit;
+        addr += v_planes;
+        mask = ~inside_mask(addr);
     }
-    return seed_type ^ 0;       /* return segment is of search color */
+
+    x = (x & ~0x000f) + first_bit(mask) - 1;
+
+    return min(x, limit);
 }
 
 
 
 /*
- * crunch_queue - move qtop down to remove unused seeds
+ * run_left - return the leftmost x coordinate (at least limit) of the
+ *            run of fillable pixels ending at x
  */
-static void crunch_queue(void)
+static WORD run_left(WORD x, WORD y, WORD limit)
 {
-    while (((qtop-1)->y == EMPTY) && (qtop > qbottom))
-        qtop--;
-    if (qptr >= qtop)
-        qptr = qbottom;
+    const UWORD *addr = get_start_addr(x, y);
+    UWORD mask = ~inside_mask(addr) & (0xffff << (15 - (x & 0x000f)));
+
+    while (!mask) {
+        x = (x & ~0x000f) - 1;      /* last pixel of previous word */
+        if (x < limit)
+            return limit;
+        addr -= v_planes;
+        mask = ~inside_mask(addr);
+    }
+
+    x = (x & ~0x000f) + last_bit(mask) + 1;
+
+    return max(x, limit);
 }
 
 
 
 /*
- * get_seed - put seeds into Q, if (xin,yin) is not of search_color
+ * visited - check if (x,y) is within a span that has already been found
+ *
+ * if so, returns TRUE and sets *hi to the end of that span.  otherwise,
+ * returns FALSE and narrows *lo and *hi to the unvisited pixels around x.
  */
-static WORD get_seed(const VwkAttrib *attr, const VwkClip *clip,
-                        WORD xin, WORD yin, WORD *xleftout, WORD *xrightout)
+static BOOL visited(WORD x, WORD y, WORD *lo, WORD *hi)
 {
-    SEGMENT *qhole;         /* an empty space in the queue */
-    SEGMENT *qtmp;
-
-    if (end_pts(clip, xin, ABS(yin), xleftout, xrightout)) {
-        /* false if of search_color */
-        for (qtmp = qbottom, qhole = NULL; qtmp < qtop; qtmp++) {
-            /* skip holes, remembering the first hole we find */
-            if (qtmp->y == EMPTY)
-            {
-                if (qhole == NULL)
-                    qhole = qtmp;
-                continue;
-            }
-            /* see, if we ran into another seed */
-            if ( ((qtmp->y ^ DOWN_FLAG) == yin) && (qtmp->xleft == *xleftout) )
-            {
-                /* we ran into another seed so remove it and fill the line */
-                Rect rect;
-
-                rect.x1 = *xleftout;
-                rect.y1 = ABS(yin);
-                rect.x2 = *xrightout;
-                rect.y2 = ABS(yin);
-
-                /* rectangle fill routine draws horizontal line */
-                draw_rect_common(attr, &rect);
-
-                qtmp->y = EMPTY;
-                if ((qtmp+1) == qtop)
-                    crunch_queue();
-                return 0;
-            }
+    const FILLSPAN *span;
+
+    for (span = span_hash[SPAN_HASH(y)]; span; span = span->hnext) {
+        if (span->y != y)
+            continue;
+        if (span->xright < x) {
+            if (span->xright >= *lo)
+                *lo = span->xright + 1;
+        } else if (span->xleft > x) {
+            if (span->xleft <= *hi)
+                *hi = span->xleft - 1;
+        } else {
+            *hi = span->xright;
+            return TRUE;
         }
+    }
+
+    return FALSE;
+}
 
-        /*
-         * there were no holes, so raise qtop if we can
-         */
-        if (qhole == NULL) {
-            if (++qtop > vdishare.queue+QSIZE) { /* can't raise qtop ... */
-                KDEBUG(("contourfill(): queue overflow\n"));
-                return -1;      /* error */
-            }
-        } else
-            qtmp = qhole;
 
-        qtmp->y = yin;      /* put the y and endpoints in the Q */
-        qtmp->xleft = *xleftout;
-        qtmp->xright = *xrightout;
-        return 1;           /* we put a seed in the Q */
+
+/*
+ * add_span - record a new span as found, and as pending to be drawn
+ *
+ * the span pool starts in vdishare, and grows if necessary by blocks of
+ * FILL_SPAN_BLOCK_SIZE bytes; returns FALSE if no memory is available
+ */
+static BOOL add_span(WORD y, WORD xleft, WORD xright)
+{
+    FILLSPAN *span;
+    SPANBLOCK *block;
+
+    if (span_next >= span_end) {
+        block = (SPANBLOCK *)Malloc(FILL_SPAN_BLOCK_SIZE);
+        if (!block) {
+            KDEBUG(("contourfill(): out of memory\n"));
+            return FALSE;
+        }
+        block->prev = span_blocks;
+        span_blocks = block;
+        span_next = block->span;
+        span_end = block->span + SPANS_PER_BLOCK;
     }
 
-    return 0;           /* we didn't put a seed in the Q */
+    span = span_next++;
+    span->y = y;
+    span->xleft = xleft;
+    span->xright = xright;
+    span->hnext = span_hash[SPAN_HASH(y)];
+    span_hash[SPAN_HASH(y)] = span;
+    span->pnext = pending;
+    pending = span;
+
+    return TRUE;
 }
 
 
 
-/* common function for line-A linea_fill() and VDI d_countourfill() */
+/*
+ * scan_line - find the unvisited runs of fillable pixels on line y that
+ *             touch the range xleft..xright, and add them as spans
+ *
+ * returns FALSE if we ran out of memory
+ */
+static BOOL scan_line(const VwkClip *clip, WORD y, WORD xleft, WORD xright)
+{
+    WORD x, lo, hi, limit;
+
+    if ((y < clip->ymn_clip) || (y > clip->ymx_clip))
+        return TRUE;
+
+    x = xleft;
+    while (x <= xright) {
+        lo = clip->xmn_clip;
+        hi = clip->xmx_clip;
+        if (visited(x, y, &lo, &hi)) {
+            x = hi + 1;             /* skip over span */
+            continue;
+        }
+
+        limit = min(hi, xright);
+        x = next_inside(x, y, limit);
+        if (x > limit)
+            continue;
+
+        /* the run may extend beyond xleft..xright, but not into another span */
+        xleft = run_left(x, y, lo);
+        x = run_right(x, y, hi);
+        if (!add_span(y, xleft, x))
+            return FALSE;
+        x++;
+    }
+
+    return TRUE;
+}
+
+
+
+/*
+ * common function for line-A linea_fill() and VDI d_countourfill()
+ *
+ * this is a span-based flood fill: fillable pixels are located 16 at a
+ * time by comparing whole screen words with the search colour.  every
+ * maximal run of fillable pixels on a line is recorded as a span, which
+ * is drawn and then used to scan the lines above and below it.  since
+ * spans are recorded when found, no pixel is examined twice, even if the
+ * fill pattern does not change whether a pixel is fillable.
+ */
 void contourfill(const VwkAttrib * attr, const VwkClip *clip)
 {
-    WORD newxleft;              /* ends of line at oldy +       */
-    WORD newxright;             /* the current direction    */
-    WORD oldxleft;              /* left end of line at oldy     */
-    WORD oldxright;             /* right end                    */
-    WORD oldy;                  /* the previous scan line       */
-    WORD xleft;                 /* temporary endpoints          */
-    WORD xright;                /* */
-    WORD direction;             /* is next scan line up or down */
-    WORD gotseed;               /* 1 => seed was put in the Q */
-                                /* 0 => no seed was put in the Q */
-                                /* -1 => queue overflowed */
-
-    xleft = PTSIN[0];
-    oldy = PTSIN[1];
-
-    if (xleft < clip->xmn_clip || xleft > clip->xmx_clip ||
-        oldy < clip->ymn_clip  || oldy > clip->ymx_clip)
+    FILLSPAN *span;
+    SPANBLOCK *block;
+    WORD x, y, i;
+
+    x = PTSIN[0];
+    y = PTSIN[1];
+
+    if (x < clip->xmn_clip || x > clip->xmx_clip ||
+        y < clip->ymn_clip || y > clip->ymx_clip)
         return;
 
     search_color = INTIN[0];
 
     if ((WORD)search_color < 0) {
-        search_color = pixelread(xleft,oldy);
+        search_color = pixelread(x,y);
         seed_type = 1;
     } else {
         /* Range check the color and convert the index to a pixel value */
@@ -893,78 +1001,49 @@ void contourfill(const VwkAttrib * attr, const VwkClip *clip)
     }
 
     /* check if anything to do */
-    if (!end_pts(clip, xleft, oldy, &oldxleft, &oldxright))
+    if (!(inside_mask(get_start_addr(x, y)) & (0x8000 >> (x & 0x000f))))
         return;
 
     /*
      * from this point on we must NOT access PTSIN[], since the area
-     * is overwritten by the queue of seeds!
+     * is overwritten by the span pool!
      */
-    qptr = qbottom = vdishare.queue;
-    qptr->y = (oldy | DOWN_FLAG);   /* stuff a point going down into the Q */
-    qptr->xleft = oldxleft;
-    qptr->xright = oldxright;
-    qtop = qptr + 1;                /* one above highest seed point */
-
-    while (1) {
-        Rect rect;
-
-        direction = (oldy & DOWN_FLAG) ? 1 : -1;
-        gotseed = get_seed(attr, clip, oldxleft, oldy+direction, &newxleft, &newxright);
-        if (gotseed < 0)
-            return;         /* error, quit */
-
-        if ((newxleft < (oldxleft - 1)) && gotseed) {
-            xleft = oldxleft;
-            while (xleft > newxleft) {
-                --xleft;
-                if (get_seed(attr, clip, xleft, oldy^DOWN_FLAG, &xleft, &xright) < 0)
-                    return; /* error, quit */
-            }
-        }
-        while (newxright < oldxright) {
-            ++newxright;
-            gotseed = get_seed(attr, clip, newxright, oldy+direction, &xleft, &newxright);
-            if (gotseed < 0)
-                return;     /* error, quit */
-        }
-        if ((newxright > (oldxright + 1)) && gotseed) {
-            xright = oldxright;
-            while (xright < newxright) {
-                ++xright;
-                if (get_seed(attr, clip, xright, oldy^DOWN_FLAG, &xleft, &xright) < 0)
-                    return; /* error, quit */
-            }
-        }
+    for (i = 0; i < SPAN_HASH_SIZE; i++)
+        span_hash[i] = NULL;
+    pending = NULL;
+    span_blocks = NULL;
+    span_next = vdishare.spans;
+    span_end = vdishare.spans + FILL_NSPANS;
+
+    if (add_span(y, run_left(x, y, clip->xmn_clip), run_right(x, y, clip->xmx_clip))) {
+        while ((span = pending) != NULL) {
+            Rect rect;
 
-        /* Eventually jump out here */
-        if (qtop == qbottom)
-            break;
+            pending = span->pnext;
 
-        while (qptr->y == EMPTY) {
-            qptr++;
-            if (qptr == qtop)
-                qptr = qbottom;
-        }
+            rect.x1 = span->xleft;
+            rect.y1 = span->y;
+            rect.x2 = span->xright;
+            rect.y2 = span->y;
 
-        oldy = qptr->y;
-        oldxleft = qptr->xleft;
-        oldxright = qptr->xright;
-        qptr->y = EMPTY;
-        if (++qptr == qtop)
-            crunch_queue();
+            /* rectangle fill routine draws horizontal line */
+            draw_rect_common(attr, &rect);
 
-        rect.x1 = oldxleft;
-        rect.y1 = ABS(oldy);
-        rect.x2 = oldxright;
-        rect.y2 = ABS(oldy);
+            /* after every line, check for early abort */
+            if ((*SEEDABORT)())
+                break;
 
-        /* rectangle fill routine draws horizontal line */
-        draw_rect_common(attr, &rect);
+            if (!scan_line(clip, span->y - 1, span->xleft, span->xright))
+                break;
+            if (!scan_line(clip, span->y + 1, span->xleft, span->xright))
+                break;
+        }
+    }
 
-        /* after every line, check for early abort */
-        if ((*SEEDABORT)())
-            break;
+    /* release any blocks added to the span pool */
+    while ((block = span_blocks) != NULL) {
+        span_blocks = block->prev;
+        Mfree(block);
     }
 }                               /* end of fill() */
 
@@ -155,6 +155,11 @@ void screen(void)
     } else {
         return;
     }
+
+#if CONF_WITH_VDI_BATCH
+    vbatch_check(vwk, opcode);  /* draw any queued operations if required */
+#endif
+
     contrl[2] = jmptab->nptsout;
     contrl[4] = jmptab->nintout;
     (*jmptab->op) (vwk);
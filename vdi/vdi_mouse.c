@@ -3,7 +3,7 @@
  *
  * Copyright 1982 by Digital Research Inc.  All rights reserved.
  * Copyright 1999 by Caldera, Inc. and Authors:
- * Copyright 2002-2022 by The EmuTOS development team
+ * Copyright 2002-2026 by The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -11,6 +11,8 @@
 
 #include "emutos.h"
 #include "asm.h"
+#include "intmath.h"
+#include "string.h"
 #include "biosbind.h"
 #include "xbiosbind.h"
 #include "obdefs.h"
@@ -46,6 +48,29 @@ extern Mcdb     mouse_cdb;              /* storage for mouse sprite */
 /* prototypes */
 static void vb_draw(void);             /* user button vector */
 
+#if CONF_WITH_VDI_BATCH
+static BOOL defer_show;         /* TRUE while a VDI batch is open */
+static BOOL show_pending;       /* TRUE if a cursor show has been held back */
+#endif
+
+#if CONF_WITH_MOUSE_SHIELD
+static volatile BOOL shielded;  /* TRUE if hidden, but left on the screen */
+static Rect shield;             /* area the cursor must keep out of */
+static Rect cursor_rect;        /* area covered by the cursor on screen */
+#endif
+
+#if CONF_WITH_MOUSE_PRESHIFT
+/*
+ * the mouse form, pre-shifted for each of the 16 possible pixel offsets
+ * within a screen word, in the same interleaved layout as maskdata[]
+ */
+static ULONG shifted_form[16][32];
+static UWORD shifted_from[32];  /* maskdata[] used to build the above */
+static UWORD form_bits;         /* OR of all words of mask & data */
+static WORD form_top;           /* first row with any bits set */
+static WORD form_bottom;        /* last row with any bits set */
+#endif
+
 /* prototypes for functions in vdi_asm.S */
 void mouse_int(void);           /* mouse interrupt routine */
 void mov_cur(void);             /* user button vector */
@@ -107,6 +132,117 @@ static const MFORM arrow_mform = {
 #endif
 
 
+/*
+ * show_cur_at - display the mouse cursor at the specified position
+ */
+static void show_cur_at(WORD x, WORD y)
+{
+    cur_display(&mouse_cdb, mcs_ptr, x, y);
+
+#if CONF_WITH_MOUSE_SHIELD
+    cursor_rect.x1 = x - mouse_cdb.xhot;
+    cursor_rect.y1 = y - mouse_cdb.yhot;
+    cursor_rect.x2 = cursor_rect.x1 + 15;
+    cursor_rect.y2 = cursor_rect.y1 + 15;
+#endif
+}
+
+
+
+#if CONF_WITH_MOUSE_SHIELD
+/*
+ * in_shield - check if the cursor would intersect the shield area
+ *
+ * x, y are the coordinates of the cursor's left/top edge
+ */
+static BOOL in_shield(WORD x, WORD y)
+{
+    return (x <= shield.x2) && (x + 15 >= shield.x1)
+        && (y <= shield.y2) && (y + 15 >= shield.y1);
+}
+
+
+
+/*
+ * unshield_cur - remove a hidden cursor that was left on the screen
+ */
+static void unshield_cur(void)
+{
+    if (shielded)
+    {
+        shielded = FALSE;       /* first, stop the VBL routine moving it */
+        cur_replace(mcs_ptr);
+    }
+}
+
+
+
+/*
+ * shield_cur - protect an area from a hidden cursor
+ *
+ * must be called with HIDE_CNT nonzero, and the cursor on the screen.
+ * the cursor is left there, and will be moved by the VBL routine as
+ * long as it stays out of the area; otherwise it is removed.
+ */
+static void shield_cur(const Rect *rect)
+{
+    shielded = FALSE;           /* the VBL routine must leave us alone */
+    shield = *rect;
+
+    if (!(mcs_ptr->stat & MCS_VALID)
+     || in_shield(cursor_rect.x1, cursor_rect.y1)
+     || (draw_flag && in_shield(newx-mouse_cdb.xhot, newy-mouse_cdb.yhot)))
+    {
+        cur_replace(mcs_ptr);   /* remove the cursor from screen */
+        draw_flag = 0;
+        return;
+    }
+
+    shielded = TRUE;
+}
+
+
+
+/*
+ * hide_cur_shield - hide the cursor, unless it is outside an area
+ *
+ * like hide_cur(), but the cursor may stay on the screen, as long as
+ * it does not intersect the specified area
+ */
+static void hide_cur_shield(const Rect *rect)
+{
+    Rect r;
+
+#if CONF_WITH_VDI_BATCH
+    if (show_pending)           /* cancel the held-back show: */
+    {
+        show_pending = FALSE;   /*  the previous area has been drawn */
+        if (shielded)
+            shield_cur(rect);
+        return;
+    }
+#endif
+
+    HIDE_CNT += 1;
+    if (HIDE_CNT == 1)          /* cursor was not hidden */
+    {
+        shield_cur(rect);
+        return;
+    }
+
+    if (shielded)               /* nested: protect both areas */
+    {
+        r.x1 = min(shield.x1, rect->x1);
+        r.y1 = min(shield.y1, rect->y1);
+        r.x2 = max(shield.x2, rect->x2);
+        r.y2 = max(shield.y2, rect->y2);
+        shield_cur(&r);
+    }
+}
+#endif
+
+
+
 /*
  * dis_cur - Displays the mouse cursor if the number of hide
  *           operations has gone back to 0.
@@ -130,7 +266,15 @@ static void dis_cur(void)
     }
 
     /* HIDE_CNT is precisely 1 at this point */
-    cur_display(&mouse_cdb, mcs_ptr, GCURX, GCURY);  /* display the cursor */
+#if CONF_WITH_MOUSE_SHIELD
+    if (shielded)           /* still on the screen: */
+    {
+        shielded = FALSE;       /* let the VBL routine move it if required */
+        HIDE_CNT--;
+        return;
+    }
+#endif
+    show_cur_at(GCURX, GCURY);  /* display the cursor */
     draw_flag = 0;              /* disable VBL drawing routine */
     HIDE_CNT--;
 }
@@ -161,6 +305,9 @@ static void hide_cur(void)
         cur_replace(mcs_ptr);   /* remove the cursor from screen */
         draw_flag = 0;          /* disable VBL drawing routine */
     }
+#if CONF_WITH_MOUSE_SHIELD
+    else unshield_cur();        /* it may still be on the screen */
+#endif
 }
 
 
@@ -315,6 +462,16 @@ void vdi_v_locator(Vwk * vwk)
  */
 void vdi_v_show_c(Vwk * vwk)
 {
+#if CONF_WITH_VDI_BATCH
+    /* during a batch, hold back a show that would make the cursor visible */
+    if (defer_show && ((HIDE_CNT == 1) || (!INTIN[0] && HIDE_CNT)))
+    {
+        HIDE_CNT = 1;
+        show_pending = TRUE;
+        return;
+    }
+#endif
+
     linea_show_mouse();
 }
 
@@ -325,11 +482,70 @@ void vdi_v_show_c(Vwk * vwk)
  */
 void vdi_v_hide_c(Vwk * vwk)
 {
+#if CONF_WITH_VDI_BATCH
+    if (show_pending)           /* cancel the held-back show: */
+    {
+        show_pending = FALSE;   /*  the cursor is still hidden */
+#if CONF_WITH_MOUSE_SHIELD
+        unshield_cur();         /*  (but may still be on the screen) */
+#endif
+        return;
+    }
+#endif
+
     linea_hide_mouse();
 }
 
 
 
+#if CONF_WITH_MOUSE_SHIELD
+/*
+ * vdi_vshield - EmuTOS escape: hide the cursor, if in the way
+ *
+ * this is used instead of v_hide_c() before drawing in an area of the
+ * screen, and must be followed by v_show_c().  if the cursor does not
+ * intersect the area, it is left on the screen, and may be moved as
+ * long as it stays out of the area.  so the cursor need not be removed
+ * and redrawn if the drawing doesn't touch it.
+ *
+ * input:
+ *   PTSIN[0-3] = corners of the area to be drawn
+ */
+void vdi_vshield(Vwk * vwk)
+{
+    Rect rect;
+
+    rect = *(Rect *)PTSIN;
+    arb_corner(&rect);
+    hide_cur_shield(&rect);
+}
+#endif
+
+
+
+#if CONF_WITH_VDI_BATCH
+/*
+ * defer_cursor_show - start/stop holding back cursor shows
+ *
+ * called when a VDI batch begins or ends.  while a batch is open, a
+ * v_show_c() that would make the cursor visible is held back, and is
+ * cancelled by a following v_hide_c(), so that the cursor is not drawn
+ * and removed again between the redraw of successive rectangles.  a
+ * show that is still pending is done when the batch ends.
+ */
+void defer_cursor_show(BOOL defer)
+{
+    defer_show = defer;
+    if (!defer && show_pending)
+    {
+        show_pending = FALSE;
+        dis_cur();
+    }
+}
+#endif
+
+
+
 /*
  * vdi_vq_mouse - Query mouse position and button status
  */
@@ -439,6 +655,44 @@ void vdi_vex_wheelv(Vwk * vwk)
 
 
 
+#if CONF_WITH_MOUSE_PRESHIFT
+/*
+ * build the pre-shifted copies of the mouse form used by cur_display()
+ */
+static void preshift_mouse_form(const Mcdb *sprite)
+{
+    const UWORD *src = sprite->maskdata;
+    ULONG *dst;
+    WORD row, shft;
+
+    memcpy(shifted_from, src, sizeof(shifted_from));
+
+    form_bits = 0;
+    form_top = 16;
+    form_bottom = -1;
+    for (row = 0; row < 16; row++, src += 2)
+    {
+        if (src[0] | src[1])
+        {
+            if (form_top > row)
+                form_top = row;
+            form_bottom = row;
+            form_bits |= src[0] | src[1];
+        }
+    }
+
+    for (shft = 0; shft < 16; shft++)
+    {
+        src = sprite->maskdata;
+        dst = shifted_form[shft];
+        for (row = 0; row < 32; row++)
+            *dst++ = (ULONG)*src++ << (16 - shft);
+    }
+}
+#endif
+
+
+
 /* copies src mouse form to dst mouse sprite, constrains hotspot
  * position & colors and maps colors
  */
@@ -483,6 +737,11 @@ static void set_mouse_form(const MFORM *src, Mcdb *dst)
         *gmdt++ = *data++;              /* get next word of data */
     }
 
+#if CONF_WITH_MOUSE_PRESHIFT
+    if (dst == &mouse_cdb)
+        preshift_mouse_form(dst);
+#endif
+
     mouse_flag -= 1;                    /* re-enable mouse drawing */
 }
 
@@ -574,6 +833,9 @@ void vdimouse_init(void)
 
     /* mouse settings */
     HIDE_CNT = 1;               /* mouse is initially hidden */
+#if CONF_WITH_MOUSE_SHIELD
+    shielded = FALSE;
+#endif
     GCURX = xres / 2;           /* initialize the mouse to center */
     GCURY = yres / 2;
 
@@ -665,8 +927,15 @@ static void vb_draw(void)
     WORD old_sr, x, y;
 
     /* if the cursor is being modified, or is hidden, just exit */
-    if (mouse_flag || HIDE_CNT)
+    if (mouse_flag)
+        return;
+#if CONF_WITH_MOUSE_SHIELD
+    if (HIDE_CNT && !shielded)
+        return;
+#else
+    if (HIDE_CNT)
         return;
+#endif
 
     old_sr = set_sr(0x2700);        /* disable interrupts */
     if (draw_flag) {
@@ -675,7 +944,15 @@ static void vb_draw(void)
         y = newy;
         set_sr(old_sr);
         cur_replace(mcs_ptr);       /* remove the old cursor from the screen */
-        cur_display(&mouse_cdb, mcs_ptr, x, y); /* display the cursor */
+#if CONF_WITH_MOUSE_SHIELD
+        /* a hidden cursor must not move into the shielded area */
+        if (HIDE_CNT && in_shield(x-mouse_cdb.xhot, y-mouse_cdb.yhot))
+        {
+            shielded = FALSE;       /* it stays hidden */
+            return;
+        }
+#endif
+        show_cur_at(x, y);          /* display the cursor */
     } else
         set_sr(old_sr);
 }
@@ -767,6 +1044,150 @@ static void cur_display_clip(WORD op,Mcdb *sprite,MCS *mcs,UWORD *mask_start,UWO
     } /* loop through planes */
 }
 
+#if CONF_WITH_MOUSE_PRESHIFT
+/*
+ * cur_display_preshift()
+ *
+ * handles cursor display for the mouse cursor when it is not subject
+ * to L/R clipping, using the pre-shifted forms.  only the rows, and
+ * the screen words, that the cursor actually changes are saved.
+ *
+ * returns FALSE if the pre-shifted forms cannot be used
+ */
+static BOOL cur_display_preshift(Mcdb *sprite, MCS *mcs, WORD x, WORD y)
+{
+    WORD top, bottom, row_count, plane, row, inc, dst_inc;
+    UWORD cdb_fg, cdb_bg;
+    UWORD cdb_mask;             /* for checking cdb_bg/cdb_fg */
+    UWORD *addr;
+    const ULONG *form;
+    ULONG used;
+
+    if ((sprite != &mouse_cdb) || (x < 0) || (x >= (xres-15)))
+        return FALSE;
+
+    /* the form may have been changed directly via the line-A variables */
+    if (memcmp(sprite->maskdata, shifted_from, sizeof(shifted_from)))
+        return FALSE;
+
+    /* rows of the form that are both visible and not empty */
+    top = max(form_top, -y);
+    bottom = min(form_bottom, yres - y);
+    if (top > bottom)
+    {
+        mcs->stat = 0x00;       /* nothing to save */
+        return TRUE;
+    }
+    row_count = bottom - top + 1;
+
+    form = shifted_form[x & 0x0f] + 2 * top;
+    used = (ULONG)form_bits << (16 - (x & 0x0f));
+    addr = get_start_addr(x, y + top);
+    inc = v_planes;             /* # distance to next word in same plane */
+    dst_inc = v_lin_wr >> 1;    /* calculate number of words in a scan line */
+
+    cdb_bg = sprite->bg_col;    /* get mouse background color bits */
+    cdb_fg = sprite->fg_col;    /* get mouse foreground color bits */
+
+    mcs->len = row_count;
+
+    /*
+     * handle the cursor overlapping two screen words
+     */
+    if ((used >> 16) && (UWORD)used)
+    {
+        ULONG *save = mcs->area;
+
+        mcs->addr = addr;
+        mcs->stat = MCS_VALID | MCS_LONGS;
+
+        for (plane = v_planes - 1, cdb_mask = 0x0001; plane >= 0; plane--) {
+            const ULONG *src = form;
+            UWORD *dst = addr++;
+
+            for (row = row_count - 1; row >= 0; row--) {
+                ULONG bits, bg, fg;
+
+                bits = ((ULONG)*dst) << 16;
+                bits |= *(dst + inc);
+                *save++ = bits;
+
+                bg = *src++;
+                fg = *src++;
+
+                if (cdb_bg & cdb_mask)
+                    bits |= bg;
+                else
+                    bits &= ~bg;
+
+                if (cdb_fg & cdb_mask)
+                    bits |= fg;
+                else
+                    bits &= ~fg;
+
+                *dst = (UWORD)(bits >> 16);
+                *(dst + inc) = (UWORD)bits;
+                dst += dst_inc;
+            }
+
+            cdb_mask <<= 1;
+        }
+        return TRUE;
+    }
+
+    /*
+     * handle the cursor lying within one screen word, either the left
+     * one or the right one
+     */
+    {
+        UWORD *save = (UWORD *)mcs->area;
+        BOOL right = !(used >> 16);
+
+        if (right)
+            addr += inc;
+        mcs->addr = addr;
+        mcs->stat = MCS_VALID;
+
+        for (plane = v_planes - 1, cdb_mask = 0x0001; plane >= 0; plane--) {
+            const ULONG *src = form;
+            UWORD *dst = addr++;
+
+            for (row = row_count - 1; row >= 0; row--) {
+                UWORD bits, bg, fg;
+
+                bits = *dst;
+                *save++ = bits;
+
+                if (right) {
+                    bg = (UWORD)*src++;
+                    fg = (UWORD)*src++;
+                } else {
+                    bg = (UWORD)(*src++ >> 16);
+                    fg = (UWORD)(*src++ >> 16);
+                }
+
+                if (cdb_bg & cdb_mask)
+                    bits |= bg;
+                else
+                    bits &= ~bg;
+
+                if (cdb_fg & cdb_mask)
+                    bits |= fg;
+                else
+                    bits &= ~fg;
+
+                *dst = bits;
+                dst += dst_inc;
+            }
+
+            cdb_mask <<= 1;
+        }
+    }
+
+    return TRUE;
+}
+#endif
+
 /*
  * cur_display() - blits a "cursor" to the destination
  *
@@ -794,6 +1215,11 @@ void cur_display (Mcdb *sprite, MCS *mcs, WORD x, WORD y)
     x -= sprite->xhot;          /* x = left side of destination block */
     y -= sprite->yhot;          /* y = top of destination block */
 
+#if CONF_WITH_MOUSE_PRESHIFT
+    if (cur_display_preshift(sprite, mcs, x, y))
+        return;
+#endif
+
     mcs->stat = 0x00;           /* reset status of save buffer */
 
     /*
@@ -159,20 +159,6 @@ struct blit_frame {
     WORD src_wr;        /* +74 source form wrap (in bytes) */
 };
 
-/* Raster definitions */
-typedef struct {
-    void *fd_addr;
-    WORD fd_w;
-    WORD fd_h;
-    WORD fd_wdwidth;
-    WORD fd_stand;
-    WORD fd_nplanes;
-    WORD fd_r1;
-    WORD fd_r2;
-    WORD fd_r3;
-} MFDB;
-
-
 #if ASM_BLIT_IS_AVAILABLE
 void fast_bit_blt(struct blit_frame *blit_info);    /* defined in vdi_blit.S */
 #endif
@@ -219,8 +219,8 @@ static WORD calc_width(Vwk *vwk, WORD cnt, WORD *str)
  *  there is no rotation
  *  the output is left-aligned
  *  the output is not justified
- *  the characters are byte-aligned
- *  the font is monospace with a cell width of 8
+ *  the font is not scaled
+ *  the font is monospace with a cell width of at most 8
  *  the font contains glyphs for all 256 characters
  *  the entire text string will not be clipped
  */
@@ -232,15 +232,12 @@ static BOOL ok_for_direct_blit(Vwk *vwk, WORD width, JUSTINFO *justified)
     if (vwk->style | vwk->chup | vwk->h_align)
         return FALSE;
 
-    if (justified)
-        return FALSE;
-
-    if (DESTX & 0x0007)
+    if (justified || vwk->scaled)
         return FALSE;
 
     fnt_ptr = vwk->cur_font;
 
-    if (!MONO || (fnt_ptr->max_cell_width != 8))
+    if (!MONO || (fnt_ptr->max_cell_width > 8))
         return FALSE;
 
     if ((fnt_ptr->first_ade != 0) || (fnt_ptr->last_ade != 255))
@@ -441,7 +438,7 @@ static void output_text(Vwk *vwk, WORD count, WORD *str, WORD width, JUSTINFO *j
      */
     if (ok_for_direct_blit(vwk, width, justified))
     {
-        direct_screen_blit(count, str);
+        direct_screen_blit(fnt_ptr, count, str);
         return;
     }
 #endif
@@ -742,12 +742,13 @@ void scale(LOCALVARS *vars)
 
 #if CONF_WITH_VDI_TEXT_SPEEDUP
 /*
- * output the font directly to the screen
+ * output an 8-pixel-wide font directly to the screen at a byte-aligned
+ * position
  *
  * note: like Atari TOS, we assume that the font contains the full
  * character set, i.e. first_ade==0, last_ade==255
  */
-void direct_screen_blit(WORD count, WORD *str)
+static void direct_aligned_blit(WORD count, WORD *str)
 {
     WORD forecol, height, mode, n, planes;
     WORD src_width, dst_width;
@@ -850,6 +851,100 @@ void direct_screen_blit(WORD count, WORD *str)
         }
     }
 }
+
+
+/*
+ * combine one plane of a glyph row with the screen word
+ *
+ * 'src' contains the glyph pixels, 'mask' the pixels covered by the
+ * character cell, and 'fore' is the current plane's bit of the text
+ * colour; the results match those of direct_aligned_blit()
+ */
+static inline UWORD glyph_word(UWORD dst, UWORD src, UWORD mask, WORD mode, WORD fore)
+{
+    switch(mode) {
+    default:    /* WM_REPLACE */
+        return (dst & ~mask) | (fore ? src : 0);
+    case WM_TRANS:
+        return fore ? (dst | src) : (dst & ~src);
+    case WM_XOR:
+        return dst ^ src;
+    case WM_ERASE:
+        return fore ? (dst | (~src & mask)) : (dst & (src | ~mask));
+    }
+}
+
+
+/*
+ * output a monospace font with a cell width of 8 or less directly to
+ * the screen at any horizontal position (e.g. the 6x6 system font)
+ *
+ * each glyph row is extracted from the font form via the offset table,
+ * then shifted to its screen position; since the cell is at most 8
+ * pixels wide, it covers at most two consecutive screen words.
+ *
+ * note: like Atari TOS, we assume that the font contains the full
+ * character set, i.e. first_ade==0, last_ade==255
+ */
+static void direct_shifted_blit(const Fonthead *font, WORD count, WORD *str)
+{
+    WORD cellwidth, forecol, height, mode, n, plane, x;
+    WORD src_width, dst_width, srcshift, dstshift;
+    UWORD cellmask, word;
+    ULONG bits, mask;
+    const UBYTE *src;
+    UWORD *dst;
+
+    cellwidth = font->max_cell_width;
+    cellmask = 0xffff << (16 - cellwidth);
+    height = DELY;
+    mode = WRT_MODE;
+    src_width = FWIDTH;
+    dst_width = v_lin_wr / sizeof(WORD);
+
+    for (x = DESTX; count > 0; count--, x += cellwidth)
+    {
+        word = font->off_table[*str++];
+        src = (const UBYTE *)FBASE + (word >> 3);
+        srcshift = word & 0x0007;
+        dst = get_start_addr(x, DESTY);
+        dstshift = x & 0x000f;
+        mask = (ULONG)cellmask << (16 - dstshift);
+
+        for (n = height; n > 0; n--, src += src_width, dst += dst_width)
+        {
+            /* the glyph row, left-aligned in a word */
+            word = src[0] << 8;
+            if (srcshift + cellwidth > 8)   /* glyph straddles two bytes */
+                word |= src[1];
+            word = (word << srcshift) & cellmask;
+            bits = (ULONG)word << (16 - dstshift);
+
+            forecol = TEXTFG;
+            for (plane = 0; plane < v_planes; plane++, forecol >>= 1)
+            {
+                dst[plane] = glyph_word(dst[plane], HIWORD(bits), HIWORD(mask),
+                                        mode, forecol & 1);
+                if (LOWORD(mask))           /* spills into next screen word */
+                    dst[v_planes+plane] = glyph_word(dst[v_planes+plane],
+                                        LOWORD(bits), LOWORD(mask), mode, forecol & 1);
+            }
+        }
+    }
+}
+
+
+/*
+ * output text directly to the screen, using the fastest method that
+ * applies to the current font and position
+ */
+void direct_screen_blit(const Fonthead *font, WORD count, WORD *str)
+{
+    if ((font->max_cell_width == 8) && !(DESTX & 0x0007))
+        direct_aligned_blit(count, str);
+    else
+        direct_shifted_blit(font, count, str);
+}
 #endif
 
 